@@ -0,0 +1,127 @@
+/**
+ *  Copyright (C) 2011
+ *  University of Rochester Department of Computer Science
+ *    and
+ *  Lehigh University Department of Computer Science and Engineering
+ *
+ * License: Modified BSD
+ *          Please see the file LICENSE.RSTM for licensing information
+ */
+
+#include <stm/config.h>
+#if defined(STM_CPU_SPARC)
+#include <sys/types.h>
+#endif
+
+/**
+ *  Step 1:
+ *    Include the configuration code for the harness, and the API code.
+ */
+
+#include <iostream>
+#include <api/api.hpp>
+#include "bmconfig.hpp"
+
+/**
+ *  We provide the option to build the entire benchmark in a single
+ *  source. The bmconfig.hpp include defines all of the important functions
+ *  that are implemented in this file, and bmharness.cpp defines the
+ *  execution infrastructure.
+ */
+#ifdef SINGLE_SOURCE_BUILD
+#include "bmharness.cpp"
+#endif
+
+/**
+ *  Step 2:
+ *    Declare the data type that will be stress tested via this benchmark.
+ *    Also provide any functions that will be needed to manipulate the data
+ *    type.  Take care to avoid unnecessary indirection.
+ *
+ *  This benchmark stresses the transactional allocator: every transaction
+ *  replaces CFG.ops randomly chosen blocks in a shared array with new blocks
+ *  of random size, and frees the old ones.  Since any thread may free any
+ *  block, most frees are of some other thread's memory.  Run it with and
+ *  without STM_SLABS to compare the slab allocator with plain malloc, and
+ *  with STM_RECLAIMER to move deferred frees off of the commit path.
+ */
+
+/*** a block that can tell if it was reused while still reachable */
+struct Block
+{
+    uint32_t size;
+    uint32_t check;
+};
+
+static const uint32_t BLOCK_MAGIC = 0x5ab5ab5a;
+
+/*** the slots we will manipulate in the experiment */
+Block** SLOTS;
+
+/*** make a block of a random size between 16 and 511 bytes */
+Block* make_block(uint32_t* seed TM_ARG)
+{
+    uint32_t size = 16 + rand_r(seed) % 496;
+    Block* b = (Block*)TM_ALLOC(size);
+    // the block is private until we write it into a slot
+    b->size = size;
+    b->check = size ^ BLOCK_MAGIC;
+    return b;
+}
+
+/**
+ *  Step 3:
+ *    Declare an instance of the data type, and provide init, test, and verify
+ *    functions
+ */
+
+/*** Initialize the slots, with blocks from malloc, which tx_free accepts */
+void bench_init()
+{
+    SLOTS = (Block**)malloc(CFG.elements * sizeof(Block*));
+    for (uint32_t i = 0; i < CFG.elements; ++i) {
+        SLOTS[i] = (Block*)malloc(sizeof(Block));
+        SLOTS[i]->size = sizeof(Block);
+        SLOTS[i]->check = sizeof(Block) ^ BLOCK_MAGIC;
+    }
+}
+
+/*** Run a bunch of replace transactions */
+void bench_test(uintptr_t, uint32_t* seed)
+{
+    // every attempt must make the same choices
+    uint32_t start = rand_r(seed);
+    TM_BEGIN(atomic) {
+        uint32_t local = start;
+        for (uint32_t o = 0; o < CFG.ops; ++o) {
+            uint32_t slot = rand_r(&local) % CFG.elements;
+            Block* b = make_block(&local TM_PARAM);
+            Block* old = TM_READ(SLOTS[slot]);
+            TM_WRITE(SLOTS[slot], b);
+            TM_FREE(old);
+        }
+    } TM_END;
+}
+
+/*** Ensure that no reachable block was handed out twice */
+bool bench_verify()
+{
+    for (uint32_t i = 0; i < CFG.elements; ++i)
+        if ((SLOTS[i]->size ^ BLOCK_MAGIC) != SLOTS[i]->check)
+            return false;
+    return true;
+}
+
+/**
+ *  Step 4:
+ *    Include the code that has the main() function, and the code for creating
+ *    threads and calling the three above-named functions.  Don't forget to
+ *    provide an arg reparser.
+ */
+
+/*** Deal with special names that map to different M values */
+void bench_reparse()
+{
+    if      (CFG.bmname == "")          CFG.bmname   = "Alloc";
+    else if (CFG.bmname == "Alloc")     CFG.elements = 256;
+}
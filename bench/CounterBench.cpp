@@ -46,6 +46,12 @@
 /*** the counter we will manipulate in the experiment */
 int counter;
 
+/*** use stm::atomic() instead of TM_BEGIN/TM_END (-B CounterLambda) */
+bool use_lambda = false;
+
+/*** increment with TM_ADD instead of a read and a write (-B CounterAdd) */
+bool use_add = false;
+
 /**
  *  Step 3:
  *    Declare an instance of the data type, and provide init, test, and verify
@@ -63,6 +69,20 @@ bench_init()
 void
 bench_test(uintptr_t, uint32_t*)
 {
+#if !defined(STM_API_CXXTM)
+    if (use_lambda) {
+        stm::atomic([&](stm::TxThread* tx) {
+            TM_WRITE(counter, 1 + TM_READ(counter));
+        });
+        return;
+    }
+#endif
+    if (use_add) {
+        TM_BEGIN(atomic) {
+            TM_ADD(counter, 1);
+        } TM_END;
+        return;
+    }
     TM_BEGIN(atomic) {
         // increment the counter
         TM_WRITE(counter, 1 + TM_READ(counter));
@@ -84,8 +104,16 @@ bench_verify()
  *    provide an arg reparser.
  */
 
-/*** no reparsing needed */
+/**
+ *  -B CounterLambda compares the lambda API with the macros, and -B
+ *  CounterAdd compares commutative updates with reads and writes
+ */
 void
 bench_reparse() {
-    CFG.bmname = "Counter";
+#if !defined(STM_API_CXXTM)
+    use_lambda = (CFG.bmname == "CounterLambda");
+#endif
+    use_add = (CFG.bmname == "CounterAdd");
+    CFG.bmname = use_lambda ? "CounterLambda"
+               : use_add    ? "CounterAdd" : "Counter";
 }
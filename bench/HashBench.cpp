@@ -39,7 +39,9 @@
  */
 
 #include "Hash.hpp"
-
+#if !defined(STM_API_CXXTM)
+#include <api/batch.hpp>
+#endif
 
 /**
  *  Step 3:
@@ -50,6 +52,29 @@
 /*** the list we will manipulate in the experiment */
 HashTable* SET;
 
+/**
+ *  -B Batch runs the same operations through a per-thread stm::batch, with
+ *  -O as the largest group, so that comparing it against the default mode
+ *  shows where batching stops paying for itself.  Each operation still
+ *  counts as one transaction.
+ */
+bool batched = false;
+
+#if !defined(STM_API_CXXTM)
+__thread stm::batch* ops = NULL;
+
+void batch_lookup(void* val TM_ARG) { SET->lookup((uintptr_t)val TM_PARAM); }
+void batch_insert(void* val TM_ARG) { SET->insert((uintptr_t)val TM_PARAM); }
+void batch_remove(void* val TM_ARG) { SET->remove((uintptr_t)val TM_PARAM); }
+
+/*** run whatever this thread still has queued, once its test is over */
+void batch_flush()
+{
+    if (ops)
+        ops->flush();
+}
+#endif
+
 /*** Initialize the counter */
 void bench_init()
 {
@@ -66,8 +91,18 @@ void bench_test(uintptr_t, uint32_t* seed)
 {
     uint32_t val = rand_r(seed) % CFG.elements;
     uint32_t act = rand_r(seed) % 100;
+#if !defined(STM_API_CXXTM)
+    if (batched) {
+        if (!ops)
+            ops = new stm::batch(CFG.ops);
+        ops->add((act < CFG.lookpct) ? batch_lookup
+                 : (act < CFG.inspct) ? batch_insert : batch_remove,
+                 (void*)(uintptr_t)val);
+        return;
+    }
+#endif
     if (act < CFG.lookpct) {
-        TM_BEGIN(atomic) {
+        TM_BEGIN_READONLY() {
             SET->lookup(val TM_PARAM);
         } TM_END;
     }
@@ -96,5 +131,11 @@ bool bench_verify() { return SET->isSane(); }
 /*** Deal with special names that map to different M values */
 void bench_reparse()
 {
-    if (CFG.bmname == "") CFG.bmname = "List";
+    if      (CFG.bmname == "")      CFG.bmname = "List";
+#if !defined(STM_API_CXXTM)
+    else if (CFG.bmname == "Batch") {
+        batched = true;
+        CFG.thread_done = batch_flush;
+    }
+#endif
 }
@@ -40,6 +40,9 @@
 
 int* matrix;
 
+/*** use stm::atomic() instead of TM_BEGIN/TM_END (-B MCASLambda) */
+bool use_lambda = false;
+
 /**
  *  Step 3:
  *    Declare an instance of the data type, and provide init, test, and verify
@@ -55,6 +58,22 @@ void bench_init()
 /*** Run a bunch of random transactions */
 void bench_test(uintptr_t, uint32_t* seed)
 {
+#if !defined(STM_API_CXXTM)
+    // no setjmp, so no volatile, but each attempt must reload the seed
+    if (use_lambda) {
+        uint32_t local;
+        stm::atomic([&](stm::TxThread* tx) {
+            local = *seed;
+            for (uint32_t i = 0; i < CFG.ops; ++i) {
+                uint32_t loc = rand_r(&local) % CFG.elements;
+                TM_WRITE(matrix[loc], 1 + TM_READ(matrix[loc]));
+            }
+        });
+        *seed = local;
+        return;
+    }
+#endif
+
     // cache the seed locally so we can restore it on abort
     //
     // NB: volatile needed because using a non-volatile local in conjunction
@@ -85,4 +104,7 @@ bool bench_verify() { return true; }
 void bench_reparse()
 {
     if      (CFG.bmname == "")          CFG.bmname   = "MCAS";
+#if !defined(STM_API_CXXTM)
+    else if (CFG.bmname == "MCASLambda") use_lambda  = true;
+#endif
 }
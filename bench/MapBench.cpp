@@ -0,0 +1,170 @@
+/**
+ *  Copyright (C) 2011
+ *  University of Rochester Department of Computer Science
+ *    and
+ *  Lehigh University Department of Computer Science and Engineering
+ *
+ * License: Modified BSD
+ *          Please see the file LICENSE.RSTM for licensing information
+ */
+
+#include <stm/config.h>
+#if defined(STM_CPU_SPARC)
+#include <sys/types.h>
+#endif
+
+/**
+ *  Step 1:
+ *    Include the configuration code for the harness, and the API code.
+ */
+#include <iostream>
+#include <api/api.hpp>
+#include "bmconfig.hpp"
+
+/**
+ *  We provide the option to build the entire benchmark in a single
+ *  source. The bmconfig.hpp include defines all of the important functions
+ *  that are implemented in this file, and bmharness.cpp defines the
+ *  execution infrastructure.
+ */
+#ifdef SINGLE_SOURCE_BUILD
+#include "bmharness.cpp"
+#endif
+
+/**
+ *  Step 2:
+ *    Declare the data type that will be stress tested via this benchmark.
+ *    Also provide any functions that will be needed to manipulate the data
+ *    type.  Take care to avoid unnecessary indirection.
+ */
+
+#include "Hash.hpp"
+#include "Tree.hpp"
+#include <api/containers.hpp>
+
+/**
+ *  This benchmark runs the same set workload as ListBench, TreeBench, and
+ *  HashBench, against those benchmarks' data structures (-B List, -B Tree,
+ *  -B Hash) or the containers of api/containers.hpp (-B HashMap, the
+ *  default, and -B SkipList), so that they can be compared directly.  The
+ *  HashMap starts with 64 buckets, so it grows during warmup.
+ */
+enum { LIST, TREE, HASH, HASHMAP, SKIPLIST } kind = HASHMAP;
+
+List*                        list;
+RBTree*                      tree;
+HashTable*                   hash;
+stm::hash_map<int, int>*     hashmap;
+stm::skiplist_map<int, int>* skiplist;
+
+TM_CALLABLE
+bool set_lookup(int val TM_ARG)
+{
+    int v;
+    switch (kind) {
+      case LIST:     return list->lookup(val TM_PARAM);
+      case TREE:     return tree->lookup(val TM_PARAM);
+      case HASH:     return hash->lookup(val TM_PARAM);
+      case HASHMAP:  return hashmap->lookup(val, v TM_PARAM);
+      default:       return skiplist->lookup(val, v TM_PARAM);
+    }
+}
+
+TM_CALLABLE
+void set_insert(int val TM_ARG)
+{
+    switch (kind) {
+      case LIST:     list->insert(val TM_PARAM); break;
+      case TREE:     tree->insert(val TM_PARAM); break;
+      case HASH:     hash->insert(val TM_PARAM); break;
+      case HASHMAP:  hashmap->insert(val, val TM_PARAM); break;
+      default:       skiplist->insert(val, val TM_PARAM); break;
+    }
+}
+
+TM_CALLABLE
+void set_remove(int val TM_ARG)
+{
+    switch (kind) {
+      case LIST:     list->remove(val TM_PARAM); break;
+      case TREE:     tree->remove(val TM_PARAM); break;
+      case HASH:     hash->remove(val TM_PARAM); break;
+      case HASHMAP:  hashmap->remove(val TM_PARAM); break;
+      default:       skiplist->remove(val TM_PARAM); break;
+    }
+}
+
+/**
+ *  Step 3:
+ *    Declare an instance of the data type, and provide init, test, and verify
+ *    functions
+ */
+
+/*** Initialize the set */
+void bench_init()
+{
+    switch (kind) {
+      case LIST:     list = new List(); break;
+      case TREE:     tree = new RBTree(); break;
+      case HASH:     hash = new HashTable(); break;
+      case HASHMAP:  hashmap = new stm::hash_map<int, int>(64); break;
+      default:       skiplist = new stm::skiplist_map<int, int>(); break;
+    }
+
+    // warm up the datastructure
+    TM_BEGIN_FAST_INITIALIZATION();
+    for (uint32_t w = 0; w < CFG.elements; w+=2)
+        set_insert(w TM_PARAM);
+    TM_END_FAST_INITIALIZATION();
+}
+
+/*** Run a bunch of random transactions */
+void bench_test(uintptr_t, uint32_t* seed)
+{
+    uint32_t val = rand_r(seed) % CFG.elements;
+    uint32_t act = rand_r(seed) % 100;
+    if (act < CFG.lookpct) {
+        TM_BEGIN_READONLY() {
+            set_lookup(val TM_PARAM);
+        } TM_END;
+    }
+    else if (act < CFG.inspct) {
+        TM_BEGIN(atomic) {
+            set_insert(val TM_PARAM);
+        } TM_END;
+    }
+    else {
+        TM_BEGIN(atomic) {
+            set_remove(val TM_PARAM);
+        } TM_END;
+    }
+}
+
+/*** Ensure the final state of the benchmark satisfies all invariants */
+bool bench_verify()
+{
+    switch (kind) {
+      case LIST:     return list->isSane();
+      case TREE:     return tree->isSane();
+      case HASH:     return hash->isSane();
+      case HASHMAP:  return hashmap->isSane();
+      default:       return skiplist->isSane();
+    }
+}
+
+/**
+ *  Step 4:
+ *    Include the code that has the main() function, and the code for creating
+ *    threads and calling the three above-named functions.  Don't forget to
+ *    provide an arg reparser.
+ */
+
+/*** Deal with special names that map to different data structures */
+void bench_reparse()
+{
+    if      (CFG.bmname == "")         CFG.bmname = "HashMap";
+    else if (CFG.bmname == "List")     kind = LIST;
+    else if (CFG.bmname == "Tree")     kind = TREE;
+    else if (CFG.bmname == "Hash")     kind = HASH;
+    else if (CFG.bmname == "SkipList") kind = SKIPLIST;
+}
@@ -0,0 +1,118 @@
+/**
+ *  Copyright (C) 2011
+ *  University of Rochester Department of Computer Science
+ *    and
+ *  Lehigh University Department of Computer Science and Engineering
+ *
+ * License: Modified BSD
+ *          Please see the file LICENSE.RSTM for licensing information
+ */
+
+#include <stm/config.h>
+#if defined(STM_CPU_SPARC)
+#include <sys/types.h>
+#endif
+
+/**
+ *  Step 1:
+ *    Include the configuration code for the harness, and the API code.
+ */
+#include <iostream>
+#include <api/api.hpp>
+#include "bmconfig.hpp"
+
+/**
+ *  We provide the option to build the entire benchmark in a single
+ *  source. The bmconfig.hpp include defines all of the important functions
+ *  that are implemented in this file, and bmharness.cpp defines the
+ *  execution infrastructure.
+ */
+#ifdef SINGLE_SOURCE_BUILD
+#include "bmharness.cpp"
+#endif
+
+/**
+ *  Step 2:
+ *    Declare the data type that will be stress tested via this benchmark.
+ *    Also provide any functions that will be needed to manipulate the data
+ *    type.  Take care to avoid unnecessary indirection.
+ */
+
+#include <api/containers.hpp>
+
+/**
+ *  Each transaction pushes or pops one element.  -B Queue (the default)
+ *  uses a bounded_queue with room for 2*m elements, and -B Deque uses a
+ *  deque, at a random end.  Both start half full, with m elements.
+ */
+enum { QUEUE, DEQUE } kind = QUEUE;
+
+stm::bounded_queue<int>* queue;
+stm::deque<int>*         dq;
+
+/**
+ *  Step 3:
+ *    Declare an instance of the data type, and provide init, test, and verify
+ *    functions
+ */
+
+/*** Initialize the queue */
+void bench_init()
+{
+    if (kind == QUEUE)
+        queue = new stm::bounded_queue<int>(2 * CFG.elements);
+    else
+        dq = new stm::deque<int>(2 * CFG.elements);
+
+    TM_BEGIN_FAST_INITIALIZATION();
+    for (uint32_t w = 0; w < CFG.elements; ++w) {
+        if (kind == QUEUE)
+            queue->push(w TM_PARAM);
+        else
+            dq->push_back(w TM_PARAM);
+    }
+    TM_END_FAST_INITIALIZATION();
+}
+
+/*** Run a bunch of random transactions */
+void bench_test(uintptr_t, uint32_t* seed)
+{
+    uint32_t act = rand_r(seed) % 4;
+    int val = rand_r(seed);
+    TM_BEGIN(atomic) {
+        if (kind == QUEUE) {
+            if (act & 1)
+                queue->push(val TM_PARAM);
+            else
+                queue->pop(val TM_PARAM);
+        }
+        else {
+            switch (act) {
+              case 0: dq->push_front(val TM_PARAM); break;
+              case 1: dq->push_back(val TM_PARAM); break;
+              case 2: dq->pop_front(val TM_PARAM); break;
+              default: dq->pop_back(val TM_PARAM); break;
+            }
+        }
+    } TM_END;
+}
+
+/*** Ensure the final state of the benchmark satisfies all invariants */
+bool bench_verify()
+{
+    return (kind == QUEUE) ? queue->isSane() : dq->isSane();
+}
+
+/**
+ *  Step 4:
+ *    Include the code that has the main() function, and the code for creating
+ *    threads and calling the three above-named functions.  Don't forget to
+ *    provide an arg reparser.
+ */
+
+/*** Deal with special names that map to different data structures */
+void bench_reparse()
+{
+    if      (CFG.bmname == "")      CFG.bmname = "Queue";
+    else if (CFG.bmname == "Deque") kind = DEQUE;
+}
@@ -41,6 +41,20 @@
 
 int* matrix;
 
+/**
+ *  -B ReadNWrite1Block reads a contiguous block instead of random elements,
+ *  and -B ReadNWrite1Range reads the same block with a single TM_READ_RANGE
+ */
+enum { RANDOM, BLOCK, RANGE } pattern = RANDOM;
+
+/**
+ *  -B ReadNWrite1Log logs each transaction's result to /dev/null with
+ *  TM_FPRINTF, and -B ReadNWrite1LogIrrevoc does it the old way, by becoming
+ *  irrevocable and calling fprintf
+ */
+enum { NO_LOG, LOG, LOG_IRREVOC } logging = NO_LOG;
+FILE* log_file = NULL;
+
 /**
  *  Step 3:
  *    Declare an instance of the data type, and provide init, test, and verify
@@ -51,6 +65,8 @@ int* matrix;
 void bench_init()
 {
     matrix = (int*)malloc(CFG.elements*sizeof(int));
+    if (logging != NO_LOG)
+        log_file = fopen("/dev/null", "w");
 }
 
 /*** Run a bunch of random transactions */
@@ -63,6 +79,30 @@ void bench_test(uintptr_t, uint32_t* seed)
     //     allow it with -Wall -Werror.
     volatile uint32_t local_seed = *seed;
 
+    if (pattern != RANDOM) {
+        uint32_t n = (CFG.ops < CFG.elements) ? CFG.ops : CFG.elements;
+        int block[1024];
+        if (n > 1024)
+            n = 1024;
+        TM_BEGIN(atomic) {
+            uint32_t start =
+                rand_r((uint32_t*)&local_seed) % (CFG.elements - n + 1);
+            int sum = 0;
+            if (pattern == RANGE) {
+                TM_READ_RANGE(block, &matrix[start], n * sizeof(int));
+                for (uint32_t i = 0; i < n; ++i)
+                    sum += block[i];
+            }
+            else {
+                for (uint32_t i = 0; i < n; ++i)
+                    sum += TM_READ(matrix[start + i]);
+            }
+            TM_WRITE(matrix[start], sum);
+        } TM_END;
+        *seed = local_seed;
+        return;
+    }
+
     TM_BEGIN(atomic) {
         int sum = 0;
         int loc = 0;
@@ -71,6 +111,15 @@ void bench_test(uintptr_t, uint32_t* seed)
             sum += TM_READ(matrix[loc]);
         }
         TM_WRITE(matrix[loc], sum);
+#if !defined(STM_API_CXXTM)
+        if (logging == LOG) {
+            TM_FPRINTF(log_file, "matrix[%d] = %d\n", loc, sum);
+        }
+        else if (logging == LOG_IRREVOC) {
+            TM_BECOME_IRREVOC();
+            fprintf(log_file, "matrix[%d] = %d\n", loc, sum);
+        }
+#endif
     } TM_END;
     *seed = local_seed;
 }
@@ -89,4 +138,8 @@ bool bench_verify() { return true; }
 void bench_reparse()
 {
     if      (CFG.bmname == "")          CFG.bmname   = "ReadNWrite1";
+    else if (CFG.bmname == "ReadNWrite1Block") pattern = BLOCK;
+    else if (CFG.bmname == "ReadNWrite1Range") pattern = RANGE;
+    else if (CFG.bmname == "ReadNWrite1Log") logging = LOG;
+    else if (CFG.bmname == "ReadNWrite1LogIrrevoc") logging = LOG_IRREVOC;
 }
@@ -69,7 +69,7 @@ void bench_test(uintptr_t, uint32_t* seed)
     uint32_t val = rand_r(seed) % CFG.elements;
     uint32_t act = rand_r(seed) % 100;
     if (act < CFG.lookpct) {
-        TM_BEGIN(atomic) {
+        TM_BEGIN_READONLY() {
             SET->lookup(val TM_PARAM);
         } TM_END;
     }
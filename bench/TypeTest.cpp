@@ -33,6 +33,12 @@
  *    Also provide any functions that will be needed to manipulate the data
  *    type.  Take care to avoid unnecessary indirection.
  */
+struct TaggedPtr
+{
+    void*     ptr;
+    uintptr_t tag;
+};
+
 struct TypeTestObject
 {
     char               m_cfield;
@@ -45,6 +51,7 @@ struct TypeTestObject
     unsigned long long m_ullfield;
     float              m_ffield;
     double             m_dfield;
+    TaggedPtr          m_pfield;
 
     TypeTestObject()
         : m_cfield('a'),
@@ -57,7 +64,10 @@ struct TypeTestObject
           m_ullfield(400000000000000000ULL),
           m_ffield(1.05f),
           m_dfield(1.07)
-    { }
+    {
+        m_pfield.ptr = this;
+        m_pfield.tag = 1;
+    }
 };
 
 /**
@@ -160,6 +170,40 @@ void DataTypeTest(TM_ARG_ALONE)
              << f2 << "," << d2 << ")\n";
     }
 #endif
+#if defined(STM_BITS_64)
+    // test a 16-byte type
+    TaggedPtr p = TM_READ(tto->m_pfield);
+    TaggedPtr p2 = p;
+    p2.tag = p.tag + 1;
+    TM_WRITE(tto->m_pfield, p2);
+    p2 = TM_READ(tto->m_pfield);
+#if !defined(STM_API_CXXTM)
+    TM_WAIVER {
+        std::cout << "(ptr,tag) from ("
+             << p.ptr << "," << p.tag << ") to ("
+             << p2.ptr << "," << p2.tag << ")\n";
+    }
+#endif
+#endif
+    // test the range calls, on a copy of the whole object and on an
+    // unaligned piece of it
+    TypeTestObject copy;
+    TM_READ_RANGE(&copy, tto, sizeof(copy));
+    copy.m_ucfield += 1;
+    copy.m_ifield += 1;
+    TM_WRITE_RANGE(&tto->m_ucfield, &copy.m_ucfield,
+                   (char*)&copy.m_uifield - (char*)&copy.m_ucfield);
+    TypeTestObject copy2;
+    TM_READ_RANGE(&copy2, tto, sizeof(copy2));
+#if !defined(STM_API_CXXTM)
+    TM_WAIVER {
+        std::cout << "range (c,uc,i,d) from ("
+             << (int)copy.m_cfield << "," << (int)uc2 << "," << i2 << ","
+             << copy.m_dfield << ") to ("
+             << (int)copy2.m_cfield << "," << (int)copy2.m_ucfield << ","
+             << copy2.m_ifield << "," << copy2.m_dfield << ")\n";
+    }
+#endif
 }
 
 /*** Initialize the counter */
@@ -174,6 +218,15 @@ void bench_test(uintptr_t, uint32_t*)
     TM_BEGIN(atomic) {
         DataTypeTest(TM_PARAM_ALONE);
     } TM_END;
+
+#if !defined(STM_API_CXXTM)
+    // a transaction that is declared read-only, but then becomes
+    // irrevocable, must still leave the next one able to start
+    TM_BEGIN_READONLY() {
+        TM_BECOME_IRREVOC();
+        TM_READ(tto->m_ifield);
+    } TM_END;
+#endif
 }
 
 /*** Ensure the final state of the benchmark satisfies all invariants */
@@ -31,6 +31,10 @@ struct Config
     uint32_t    inspct;                 // insert percent
     uint32_t    sets;                   // number of sets to create
     uint32_t    ops;                    // operations per transaction
+    std::string qtable;                 // training output file (-T)
+    std::string train_algs;             // algorithms to train on (-A)
+    uint32_t    trials;                 // training trials per point
+    void        (*thread_done)();       // called after a thread's last test
 
     /*** THESE GET UPDATED LATER ***/
     volatile uint64_t time;
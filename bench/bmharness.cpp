@@ -18,6 +18,9 @@
 #include <api/api.hpp>
 #include <common/platform.hpp>
 #include <common/locks.hpp>
+#ifndef STM_API_CXXTM
+#include <stm/lib_globals.hpp> // train_*
+#endif
 #include "bmconfig.hpp"
 
 using std::string;
@@ -34,6 +37,10 @@ Config::Config() :
     inspct(66),
     sets(1),
     ops(1),
+    qtable(""),
+    train_algs("OrecEager,OrecLazy,NOrec,RingSW"),
+    trials(3),
+    thread_done(NULL),
     time(0),
     running(true),
     txcount(0)
@@ -78,6 +85,11 @@ namespace
       std::cerr << "    -B: name of benchmark\n";
       std::cerr << "    -S: number of sets to build (default 1)\n";
       std::cerr << "    -O: operations per transaction (default 1)\n";
+      std::cerr << "    -T: train CBR: append best algorithms for 1..p threads\n"
+                << "        to this binary qtable (use with STM_QTABLE)\n";
+      std::cerr << "    -A: comma-separated algorithms to train on\n"
+                << "        (default OrecEager,OrecLazy,NOrec,RingSW)\n";
+      std::cerr << "    -t: trials to average per training point (default 3)\n";
       std::cerr << "    -h: print help (this message)\n\n";
   }
 
@@ -89,7 +101,7 @@ parseargs(int argc, char** argv)
 {
     // parse the command-line options
     int opt;
-    while ((opt = getopt(argc, argv, "N:d:p:hX:B:m:R:S:O:")) != -1) {
+    while ((opt = getopt(argc, argv, "N:d:p:hX:B:m:R:S:O:T:A:t:")) != -1) {
         switch(opt) {
           case 'd': CFG.duration      = strtol(optarg, NULL, 10); break;
           case 'p': CFG.threads       = strtol(optarg, NULL, 10); break;
@@ -99,6 +111,9 @@ parseargs(int argc, char** argv)
           case 'm': CFG.elements      = strtol(optarg, NULL, 10); break;
           case 'S': CFG.sets          = strtol(optarg, NULL, 10); break;
           case 'O': CFG.ops           = strtol(optarg, NULL, 10); break;
+          case 'T': CFG.qtable        = std::string(optarg); break;
+          case 'A': CFG.train_algs    = std::string(optarg); break;
+          case 't': CFG.trials        = strtol(optarg, NULL, 10); break;
           case 'R':
             CFG.lookpct = strtol(optarg, NULL, 10);
             CFG.inspct = (100 - CFG.lookpct)/2 + strtol(optarg, NULL, 10);
@@ -127,12 +142,14 @@ extern "C" void catch_SIGALRM(int) {
 }
 
 /**
- *  Support a few lightweight barriers
+ *  Support a few lightweight barriers.  They are single-use, except that
+ *  training mode resets them between runs, when no thread is inside one.
  */
+volatile uint32_t barriers[16] = {0};
+
 void
 barrier(uint32_t which)
 {
-    static volatile uint32_t barriers[16] = {0};
     CFENCE;
     fai32(&barriers[which]);
     while (barriers[which] != CFG.threads) { }
@@ -178,6 +195,10 @@ run(uintptr_t id)
         }
     }
 
+    // let the benchmark finish any work that this thread has left queued
+    if (CFG.thread_done)
+        CFG.thread_done();
+
     // wait until all txns finish, then get time
     barrier(2);
     if (id == 0)
@@ -203,6 +224,128 @@ run_wrapper(void* i)
     TM_THREAD_SHUTDOWN();
     return NULL;
 }
+
+#ifndef STM_API_CXXTM
+/**
+ *  In-process CBR training
+ *
+ *    Training reruns the benchmark many times, at different thread counts and
+ *    with different algorithms.  TxThreads are never reclaimed, so rather
+ *    than create threads for each run we keep a pool of workers, and release
+ *    the first CFG.threads of them for each run.
+ */
+pthread_mutex_t train_lock = PTHREAD_MUTEX_INITIALIZER;
+pthread_cond_t  train_cond = PTHREAD_COND_INITIALIZER;
+uint32_t        train_round = 0;
+bool            train_done = false;
+volatile uint32_t train_finished = 0;
+
+/*** pool worker: wait for a run, take part if selected, repeat */
+NOINLINE
+void*
+train_worker(void* i)
+{
+    uintptr_t id = (uintptr_t)i;
+    uint32_t seen = 0;
+    TM_THREAD_INIT();
+    while (true) {
+        pthread_mutex_lock(&train_lock);
+        while (train_round == seen && !train_done)
+            pthread_cond_wait(&train_cond, &train_lock);
+        seen = train_round;
+        bool done = train_done;
+        pthread_mutex_unlock(&train_lock);
+        if (done)
+            break;
+        if (id < CFG.threads) {
+            run(id);
+            faa32(&train_finished, 1);
+        }
+    }
+    TM_THREAD_SHUTDOWN();
+    return NULL;
+}
+
+/*** do one run with 'threads' threads, and return its throughput */
+uint64_t
+train_run(uint32_t threads)
+{
+    CFG.threads = threads;
+    CFG.running = true;
+    CFG.txcount = 0;
+    for (int b = 0; b < 16; ++b)
+        barriers[b] = 0;
+    train_finished = 0;
+    WBR;
+    pthread_mutex_lock(&train_lock);
+    ++train_round;
+    pthread_cond_broadcast(&train_cond);
+    pthread_mutex_unlock(&train_lock);
+
+    run(0);
+    while (train_finished != threads - 1)
+        spin64();
+    return (1000000000LL * CFG.txcount) / (CFG.time ? CFG.time : 1);
+}
+
+/**
+ *  Profile the workload once with ProfileAppAvg, then for each thread count
+ *  find the algorithm with the best average throughput, and append one
+ *  qtable record per thread count.
+ */
+void
+train(const char* progname)
+{
+    uint32_t maxthreads = CFG.threads;
+    pthread_t tid[256];
+    for (uintptr_t j = 1; j < maxthreads; j++)
+        pthread_create(&tid[j], NULL, &train_worker, (void*)j);
+
+    // name the record after the configuration, like demo_train_cbr.pl did
+    const char* slash = strrchr(progname, '/');
+    char bm[256];
+    snprintf(bm, sizeof(bm), "%s-B%s-R%u-m%u", slash ? slash + 1 : progname,
+             CFG.bmname.c_str(), CFG.lookpct, CFG.elements);
+
+    TM_SET_POLICY("ProfileAppAvg");
+    stm::train_profile_begin();
+    train_run(1);
+    stm::train_profile_end();
+
+    for (uint32_t p = 1; p <= maxthreads; p++) {
+        std::string best;
+        uint64_t best_tput = 0;
+        std::string algs = CFG.train_algs + ",";
+        for (size_t b = 0, e; (e = algs.find(',', b)) != string::npos; b = e+1) {
+            std::string alg = algs.substr(b, e - b);
+            if (alg.empty())
+                continue;
+            TM_SET_POLICY(alg.c_str());
+            uint64_t tput = 0;
+            for (uint32_t t = 0; t < CFG.trials; t++)
+                tput += train_run(p);
+            tput /= (CFG.trials ? CFG.trials : 1);
+            std::cout << "train, B=" << bm << ", p=" << p << ", ALG=" << alg
+                      << ", throughput=" << tput << std::endl;
+            if (tput > best_tput) {
+                best_tput = tput;
+                best = alg;
+            }
+        }
+        if (!best.empty() &&
+            !stm::train_write_row(CFG.qtable.c_str(), bm, best.c_str(), p))
+            std::cerr << "Unable to write qtable " << CFG.qtable << std::endl;
+    }
+
+    pthread_mutex_lock(&train_lock);
+    train_done = true;
+    pthread_cond_broadcast(&train_cond);
+    pthread_mutex_unlock(&train_lock);
+    for (uint32_t k = 1; k < maxthreads; k++)
+        pthread_join(tid[k], NULL);
+    CFG.threads = maxthreads;
+}
+#endif
 }
 
 /**
@@ -216,6 +359,16 @@ int main(int argc, char** argv) {
     TM_THREAD_INIT();
     bench_init();
 
+#ifndef STM_API_CXXTM
+    if (!CFG.qtable.empty()) {
+        train(argv[0]);
+        bool v = bench_verify();
+        std::cout << "Verification: " << (v ? "Passed" : "Failed") << "\n";
+        TM_SYS_SHUTDOWN();
+        return 0;
+    }
+#endif
+
     void* args[256];
     pthread_t tid[256];
 
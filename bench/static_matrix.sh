@@ -0,0 +1,45 @@
+#!/bin/sh
+#
+#  Copyright (C) 2011
+#  University of Rochester Department of Computer Science
+#    and
+#  Lehigh University Department of Computer Science and Engineering
+#
+# License: Modified BSD
+#          Please see the file LICENSE.RSTM for licensing information
+
+## Compare the static-dispatch builds of the benchmarks with the usual ones.
+## Run it from the bench directory of a build that was configured with
+## libstm_static_dispatch set, e.g.:
+##
+##     static_matrix.sh "CGL TML" "Counter Tree List Hash" "1 4" "-d2 -O16"
+##
+## For each algorithm, benchmark, and thread count, it prints the best
+## throughput of three runs of <bench>BenchSSB64 and <bench>BenchSSB64<alg>.
+
+algs=${1:-"CGL TML"}
+benches=${2:-"Counter Tree List Hash ReadNWrite1"}
+threads=${3:-"1 4"}
+flags=${4:-"-d1"}
+
+best() {
+    b=0
+    for r in 1 2 3; do
+        t=$(STM_CONFIG=$1 ./$2 -p$3 $flags 2>&1 |
+            sed -n 's/.*throughput=\([0-9]*\).*/\1/p')
+        [ "${t:-0}" -gt $b ] && b=$t
+    done
+    echo $b
+}
+
+printf "%-5s %-12s %3s %12s %12s %7s\n" alg bench p dynamic static speedup
+for alg in $algs; do
+    for bench in $benches; do
+        for p in $threads; do
+            d=$(best $alg ${bench}BenchSSB64 $p)
+            s=$(best $alg ${bench}BenchSSB64$alg $p)
+            printf "%-5s %-12s %3s %12s %12s %7s\n" $alg $bench $p $d $s \
+                $(awk "BEGIN { if ($d) printf \"%.2f\", $s / $d }")
+        done
+    done
+done
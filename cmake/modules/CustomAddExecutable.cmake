@@ -8,6 +8,7 @@
 #          Please see the file LICENSE.RSTM for licensing information
 
 include (AppendProperty)
+include (AddTargetDefinitions)
 
 ## We have set up RSTM so that it can be configured to independently build 32
 ## and 64-bit libraries and executables. The user can configure a build
@@ -54,6 +55,17 @@ macro (add_stm_executable exec name arch)
   target_link_libraries(${${exec}} stm${arch})
 endmacro ()
 
+## Add a multiarch executable that uses a static-dispatch variant of the
+## stm library (see libstm_static_dispatch).
+macro (add_static_stm_executable exec name arch alg)
+  set(${exec} "${name}${arch}${alg}")
+  add_executable(${${exec}} ${ARGN})
+  append_property(TARGET ${${exec}} LINK_FLAGS -m${arch})
+  append_property(TARGET ${${exec}} COMPILE_FLAGS -m${arch})
+  add_target_definitions(${${exec}} STM_STATIC_DISPATCH_${alg})
+  target_link_libraries(${${exec}} stm${arch}${alg})
+endmacro ()
+
 ## Add a multiarch executable that uses Intel's itm library.
 macro (add_itm_executable exec name arch)
   add_cxxtm_executable(${exec} ${name} ${arch} ${ARGN})
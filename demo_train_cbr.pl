@@ -9,6 +9,12 @@
 # License: Modified BSD
 #          Please see the file LICENSE.RSTM for licensing information
 
+#
+# NB: the benchmarks can now train in-process, e.g.
+#       TreeBenchSSB64 -BRBTree -R33 -p8 -T cbr.qtbl
+#     which appends binary records that STM_QTABLE accepts directly.  This
+#     script remains for producing the textual .q format.
+
 #######################################################
 #
 # Begin User-Specified Configuration Fields
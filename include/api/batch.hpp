@@ -0,0 +1,115 @@
+/**
+ *  Copyright (C) 2011
+ *  University of Rochester Department of Computer Science
+ *    and
+ *  Lehigh University Department of Computer Science and Engineering
+ *
+ * License: Modified BSD
+ *          Please see the file LICENSE.RSTM for licensing information
+ */
+
+/**
+ *  stm::batch runs small, independent operations several to a transaction,
+ *  so that they share the fixed cost of begin and commit (the scope CAS, the
+ *  allocator epoch, the timestamps, and the algorithm's own begin and
+ *  commit work).
+ *
+ *  A thread add()s an operation, which is a function and an argument, and
+ *  the batch runs the queued operations once there are enough of them, or
+ *  when the thread calls flush().  Each group of operations is one
+ *  transaction, so each operation is still atomic; all that changes is that
+ *  its neighbors commit with it.  An operation must not depend on one queued
+ *  before it having committed, and its results (which it leaves in *arg, or
+ *  hands to TM_ON_COMMIT) are only ready once the group has committed.
+ *
+ *  The group size adapts: it grows by one after each group that commits
+ *  without aborting, up to the batch's limit, and halves each time a group
+ *  aborts, in which case the retry only runs the first half of the group.
+ *  Small groups of conflicting operations stay small, and groups of
+ *  operations that rarely conflict grow until begin and commit are noise.
+ *
+ *  A batch belongs to one thread, and must be used outside of transactions.
+ */
+
+#ifndef API_BATCH_HPP__
+#define API_BATCH_HPP__
+
+#include <cstdlib>
+#include <cstring>
+#include <api/api.hpp>
+
+namespace stm
+{
+  class batch
+  {
+      struct op_t
+      {
+          void (*fn)(void* arg TM_ARG);
+          void* arg;
+      };
+
+      op_t*    ops;
+      uint32_t count;           // operations queued
+      uint32_t limit;           // the largest group
+      uint32_t group;           // the current group size, in [1, limit]
+      uint32_t attempts;        // tries at the current group
+      bool     aborted;         // did the current group abort?
+
+      /*** run the first ops as one transaction, and drop them */
+      void run_group()
+      {
+          uint32_t n = 0;
+          aborted = false;
+          attempts = 0;
+          TM_BEGIN(atomic) {
+              // this is a retry: halve the group, and only redo its front.
+              // We count tries ourselves, since the library's abort count
+              // is reset when the algorithm changes.
+              if (attempts++) {
+                  aborted = true;
+                  if (group > 1)
+                      group /= 2;
+              }
+              n = (count < group) ? count : group;
+              for (uint32_t i = 0; i < n; ++i)
+                  ops[i].fn(ops[i].arg TM_PARAM);
+          } TM_END;
+          if (!aborted && (n == group) && (group < limit))
+              ++group;
+          count -= n;
+          memmove(ops, ops + n, count * sizeof(op_t));
+      }
+
+    public:
+
+      /*** max_group (at least 1) bounds the group size */
+      batch(uint32_t max_group = 64)
+          : ops((op_t*)malloc(max_group * sizeof(op_t))), count(0),
+            limit(max_group), group(1), attempts(0), aborted(false)
+      { }
+
+      /*** call flush() first, or queued operations are lost */
+      ~batch() { free(ops); }
+
+      /*** queue fn(arg), and run a group if there are enough */
+      void add(void (*fn)(void* arg TM_ARG), void* arg)
+      {
+          ops[count].fn  = fn;
+          ops[count].arg = arg;
+          if (++count >= group)
+              run_group();
+      }
+
+      /*** run everything that is queued */
+      void flush()
+      {
+          while (count)
+              run_group();
+      }
+
+      uint32_t queued()     const { return count; }
+      uint32_t group_size() const { return group; }
+  };
+} // namespace stm
+
+#endif // API_BATCH_HPP__
@@ -0,0 +1,37 @@
+/**
+ *  Copyright (C) 2011
+ *  University of Rochester Department of Computer Science
+ *    and
+ *  Lehigh University Department of Computer Science and Engineering
+ *
+ * License: Modified BSD
+ *          Please see the file LICENSE.RSTM for licensing information
+ */
+
+/**
+ *  The default hash for stm::hash_map and stm::skiplist_map keys: a
+ *  multiplicative (Fibonacci) hash of the key's bits, so that consecutive
+ *  integer keys land in different buckets, and get well-spread skiplist
+ *  levels.  Keys must be integers or pointers; give the containers your own
+ *  hash for anything else.
+ */
+
+#ifndef API_CONTAINER_HASH_HPP__
+#define API_CONTAINER_HASH_HPP__
+
+#include <stdint.h>
+
+namespace stm
+{
+  template <typename K>
+  struct container_hash
+  {
+      uintptr_t operator()(K key) const
+      {
+          uint64_t x = (uint64_t)(uintptr_t)key * 0x9E3779B97F4A7C15ULL;
+          return (uintptr_t)(x ^ (x >> 29));
+      }
+  };
+} // namespace stm
+
+#endif // API_CONTAINER_HASH_HPP__
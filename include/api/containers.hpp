@@ -0,0 +1,41 @@
+/**
+ *  Copyright (C) 2011
+ *  University of Rochester Department of Computer Science
+ *    and
+ *  Lehigh University Department of Computer Science and Engineering
+ *
+ * License: Modified BSD
+ *          Please see the file LICENSE.RSTM for licensing information
+ */
+
+/**
+ *  Header-only transactional containers, built on the TM_ macros of api.hpp,
+ *  so that they work with both the library and the compiler APIs:
+ *
+ *    stm::hash_map<K, V>      (hash_map.hpp)  grows by incremental rehash
+ *    stm::skiplist_map<K, V>  (skiplist.hpp)  ordered
+ *    stm::bounded_queue<T>    (queue.hpp)     FIFO, fixed capacity
+ *    stm::deque<T>            (deque.hpp)     double-ended, grows
+ *
+ *  Like the data structures in bench/, each method takes the transaction
+ *  (TM_ARG), and must be called from inside one.  Construction and
+ *  destruction are not transactional.  Keys, values, and elements must be
+ *  types that TM_READ and TM_WRITE can handle: integers, floats, and
+ *  pointers.
+ *
+ *  All of them are designed for word-based STMs: they keep the read set
+ *  small (fields that never change after a node is published are read
+ *  without barriers, since the link that led to the node is in the read set
+ *  already), and avoid words that every transaction writes, like element
+ *  counts, which are the usual source of false conflicts.
+ */
+
+#ifndef API_CONTAINERS_HPP__
+#define API_CONTAINERS_HPP__
+
+#include <api/hash_map.hpp>
+#include <api/skiplist.hpp>
+#include <api/queue.hpp>
+#include <api/deque.hpp>
+
+#endif // API_CONTAINERS_HPP__
@@ -20,6 +20,8 @@
 #ifndef STM_API_CXXTM_HPP
 #define STM_API_CXXTM_HPP
 
+#include <cstring> // memcpy(), for the range calls
+
 // The prototype icc stm compiler version 4.0 doesn't understand transactional
 // malloc and free without some help. The ifdef guard could be more intelligent.
 #if defined(__ICC)
@@ -32,6 +34,7 @@ extern "C" {
 #define TM_CALLABLE         [[transaction_safe]]
 
 #define TM_BEGIN(TYPE)      __transaction [[TYPE]] {
+#define TM_BEGIN_READONLY() __transaction [[atomic]] {
 #define TM_END              }
 
 #define TM_WAIVER           __transaction [[waiver]]
@@ -44,6 +47,12 @@ extern "C" {
 
 #define TM_READ(x) (x)
 #define TM_WRITE(x, y) (x) = (y)
+#define TM_ADD(x, y) (x) += (y)
+#define TM_MAX(x, y) ((x) < (y) ? (void)((x) = (y)) : (void)0)
+#define TM_MIN(x, y) ((y) < (x) ? (void)((x) = (y)) : (void)0)
+#define TM_READ_RANGE(dst, src, len)  memcpy(dst, src, len)
+#define TM_WRITE_RANGE(dst, src, len) memcpy(dst, src, len)
+#define TM_MEMCPY(dst, src, len)      memcpy(dst, src, len)
 
 namespace stm
 {
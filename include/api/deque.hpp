@@ -0,0 +1,173 @@
+/**
+ *  Copyright (C) 2011
+ *  University of Rochester Department of Computer Science
+ *    and
+ *  Lehigh University Department of Computer Science and Engineering
+ *
+ * License: Modified BSD
+ *          Please see the file LICENSE.RSTM for licensing information
+ */
+
+/**
+ *  stm::deque is a transactional double-ended queue that grows as needed
+ *  (see containers.hpp for what all of the containers have in common).
+ *
+ *  It is a ring of slots, like bounded_queue: the elements are in the slots
+ *  from front up to (not including) back, and each slot says whether it is
+ *  full.  An operation on one end only reads and writes that end's index and
+ *  the slot next to it, so the two ends only conflict when the deque is
+ *  (nearly) empty, or when a push finds the ring full and has to copy it
+ *  into one twice the size.  The indices count up and down without wrapping
+ *  into the ring; a slot is found by masking.
+ */
+
+#ifndef API_DEQUE_HPP__
+#define API_DEQUE_HPP__
+
+#include <cstdlib>
+#include <cstring>
+#include <api/api.hpp>
+
+namespace stm
+{
+  template <typename T>
+  class deque
+  {
+      struct slot_t
+      {
+          T         val;
+          uintptr_t full;
+      };
+
+      /*** a ring only changes size by being replaced */
+      struct ring_t
+      {
+          uintptr_t mask;       // never changes
+          slot_t    slots[1];
+      };
+
+      ring_t*   ring;
+      char      pad1[CACHELINE_BYTES];
+      uintptr_t front;          // the first full slot
+      char      pad2[CACHELINE_BYTES];
+      uintptr_t back;           // the slot after the last full one
+      char      pad3[CACHELINE_BYTES];
+
+      static ring_t* new_ring(uintptr_t size, bool in_tx)
+      {
+          size_t bytes = sizeof(ring_t) + (size - 1) * sizeof(slot_t);
+          ring_t* r = (ring_t*)(in_tx ? TM_ALLOC(bytes) : malloc(bytes));
+          memset(r, 0, bytes);
+          r->mask = size - 1;
+          return r;
+      }
+
+      /*** copy the elements into a ring twice the size */
+      TM_CALLABLE
+      ring_t* grow(ring_t* r TM_ARG)
+      {
+          uintptr_t f = TM_READ(front), b = TM_READ(back);
+          ring_t* nr = new_ring(2 * (r->mask + 1), true);
+          for (uintptr_t i = f; i != b; ++i) {
+              slot_t* s = &nr->slots[i & nr->mask];
+              s->val = TM_READ(r->slots[i & r->mask].val);
+              s->full = 1;
+          }
+          TM_WRITE(ring, nr);
+          TM_FREE(r);
+          return nr;
+      }
+
+    public:
+
+      /*** capacity is rounded up to a power of 2 */
+      deque(uintptr_t capacity = 64) : front(0), back(0)
+      {
+          uintptr_t n = 1;
+          while (n < capacity)
+              n <<= 1;
+          ring = new_ring(n, false);
+      }
+
+      /*** not thread safe */
+      ~deque() { free(ring); }
+
+      TM_CALLABLE
+      void push_back(T val TM_ARG)
+      {
+          ring_t* r = TM_READ(ring);
+          uintptr_t b = TM_READ(back);
+          slot_t* s = &r->slots[b & r->mask];
+          if (TM_READ(s->full)) {
+              r = grow(r TM_PARAM);
+              s = &r->slots[b & r->mask];
+          }
+          TM_WRITE(s->val, val);
+          TM_WRITE(s->full, (uintptr_t)1);
+          TM_WRITE(back, b + 1);
+      }
+
+      TM_CALLABLE
+      void push_front(T val TM_ARG)
+      {
+          ring_t* r = TM_READ(ring);
+          uintptr_t f = TM_READ(front) - 1;
+          slot_t* s = &r->slots[f & r->mask];
+          if (TM_READ(s->full)) {
+              r = grow(r TM_PARAM);
+              s = &r->slots[f & r->mask];
+          }
+          TM_WRITE(s->val, val);
+          TM_WRITE(s->full, (uintptr_t)1);
+          TM_WRITE(front, f);
+      }
+
+      TM_CALLABLE
+      bool pop_front(T& val TM_ARG)
+      {
+          ring_t* r = TM_READ(ring);
+          uintptr_t f = TM_READ(front);
+          slot_t* s = &r->slots[f & r->mask];
+          if (!TM_READ(s->full))
+              return false;
+          val = TM_READ(s->val);
+          TM_WRITE(s->full, (uintptr_t)0);
+          TM_WRITE(front, f + 1);
+          return true;
+      }
+
+      TM_CALLABLE
+      bool pop_back(T& val TM_ARG)
+      {
+          ring_t* r = TM_READ(ring);
+          uintptr_t b = TM_READ(back) - 1;
+          slot_t* s = &r->slots[b & r->mask];
+          if (!TM_READ(s->full))
+              return false;
+          val = TM_READ(s->val);
+          TM_WRITE(s->full, (uintptr_t)0);
+          TM_WRITE(back, b);
+          return true;
+      }
+
+      /**
+       *  Make sure that exactly the slots from front to back are full.  Not
+       *  thread safe.
+       */
+      bool isSane() const
+      {
+          uintptr_t n = back - front;
+          if (n > ring->mask + 1)
+              return false;
+          for (uintptr_t i = 0; i <= ring->mask; ++i) {
+              bool inside = ((i - front) & ring->mask) < n;
+              if ((n == ring->mask + 1) ? !ring->slots[i].full
+                                        : (inside != !!ring->slots[i].full))
+                  return false;
+          }
+          return true;
+      }
+  };
+} // namespace stm
+
+#endif // API_DEQUE_HPP__
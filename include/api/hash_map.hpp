@@ -0,0 +1,354 @@
+/**
+ *  Copyright (C) 2011
+ *  University of Rochester Department of Computer Science
+ *    and
+ *  Lehigh University Department of Computer Science and Engineering
+ *
+ * License: Modified BSD
+ *          Please see the file LICENSE.RSTM for licensing information
+ */
+
+/**
+ *  stm::hash_map is a transactional hash map that grows without stopping
+ *  the world (see containers.hpp for what all of the containers have in
+ *  common).
+ *
+ *  The table doubles once it holds more than two entries per bucket.  The
+ *  transaction that notices swaps in a new table, and keeps the old one
+ *  around.  From then on, a writer first moves the old bucket of its key to
+ *  the new table, and then one more bucket, chosen by a per-thread cursor,
+ *  so that writers in different parts of the table don't conflict.  A moved
+ *  bucket's head is MOVED.  Lookups never move anything, so they stay
+ *  read-only: they look in the old bucket, and in the new one if it has
+ *  moved.  Once every old bucket has moved, the next writer drops the old
+ *  table.
+ *
+ *  The element count, which decides when to grow, and the count of moved
+ *  buckets are striped: each thread reads and writes its own stripe through
+ *  the barriers, so that inserts and removes don't all conflict on one
+ *  word.  The element count is only read as a hint, outside of the
+ *  barriers.  The moved count is too, until the hint says that every bucket
+ *  has moved, and then the transaction that drops the old table reads it
+ *  properly, since the hint can include uncommitted writes.
+ */
+
+#ifndef API_HASH_MAP_HPP__
+#define API_HASH_MAP_HPP__
+
+#include <cstdlib>
+#include <cstring>
+#include <api/api.hpp>
+#include <api/container_hash.hpp>
+
+namespace stm
+{
+  template <typename K, typename V, class H = container_hash<K> >
+  class hash_map
+  {
+      enum { STRIPES = 8 };
+
+      struct node_t
+      {
+          K       key;  // never changes once the node is in the map
+          V       val;
+          node_t* next;
+      };
+
+      struct table_t
+      {
+          uintptr_t mask;               // never changes
+          uintptr_t moved[STRIPES];     // buckets moved out
+          node_t*   buckets[1];
+      };
+
+      /*** the tables never change, so a writer swaps in a new state */
+      struct state_t
+      {
+          table_t* cur;
+          table_t* old;         // NULL unless we are growing
+      };
+
+      state_t*  state;
+      uintptr_t count[STRIPES];         // elements
+      H         hash;
+
+      static node_t* MOVED() { return (node_t*)1; }
+
+      /*** make a table outside of any transaction, or inside the one that
+       *   will publish it */
+      static table_t* new_table(uintptr_t size, bool in_tx)
+      {
+          size_t bytes = sizeof(table_t) + (size - 1) * sizeof(node_t*);
+          table_t* t = (table_t*)(in_tx ? TM_ALLOC(bytes) : malloc(bytes));
+          memset(t, 0, bytes);
+          t->mask = size - 1;
+          return t;
+      }
+
+      /*** a read hint; the value is only used to decide when to grow */
+      static uintptr_t peek(const uintptr_t& v)
+      {
+          return *(volatile const uintptr_t*)&v;
+      }
+
+      /*** the calling thread's stripe of a striped count */
+      static uintptr_t stripe()
+      {
+          static uintptr_t next = 0;
+          static __thread uintptr_t mine = 0; // 0 == not picked yet
+          if (!mine)
+              mine = __sync_add_and_fetch(&next, 1);
+          return mine % STRIPES;
+      }
+
+      /*** add to a striped count, through the barriers */
+      TM_CALLABLE
+      static void add(uintptr_t* stripes, uintptr_t val TM_ARG)
+      {
+          uintptr_t* c = &stripes[stripe()];
+          TM_WRITE(*c, TM_READ(*c) + val);
+      }
+
+      /*** the sum of a striped count, as a hint */
+      static uintptr_t peek_sum(const uintptr_t* stripes)
+      {
+          uintptr_t sum = 0;
+          for (int i = 0; i < STRIPES; ++i)
+              sum += peek(stripes[i]);
+          return sum;
+      }
+
+      /*** true if every bucket of old has moved */
+      TM_CALLABLE
+      static bool all_moved(table_t* old TM_ARG)
+      {
+          if (peek_sum(old->moved) <= old->mask)
+              return false;
+          uintptr_t sum = 0;
+          for (int i = 0; i < STRIPES; ++i)
+              sum += TM_READ(old->moved[i]);
+          return sum > old->mask;
+      }
+
+      TM_CALLABLE
+      node_t* find(node_t* n, K key TM_ARG) const
+      {
+          while (n && (n->key != key))
+              n = TM_READ(n->next);
+          return n;
+      }
+
+      /**
+       *  Move old bucket i to the new table: old bucket i splits into new
+       *  buckets i and i + old size.  Returns false if it had already moved.
+       */
+      TM_CALLABLE
+      bool move(state_t* s, uintptr_t i TM_ARG)
+      {
+          table_t* old = s->old;
+          node_t* n = TM_READ(old->buckets[i]);
+          if (n == MOVED())
+              return false;
+          table_t* cur = s->cur;
+          while (n) {
+              node_t* next = TM_READ(n->next);
+              node_t** b = &cur->buckets[hash(n->key) & cur->mask];
+              TM_WRITE(n->next, TM_READ(*b));
+              TM_WRITE(*b, n);
+              n = next;
+          }
+          TM_WRITE(old->buckets[i], MOVED());
+          add(old->moved, 1 TM_PARAM);
+          return true;
+      }
+
+      /**
+       *  Before a writer touches the new table, it moves its key's bucket,
+       *  and helps with one more, so that we finish.  Returns the state the
+       *  writer should use.
+       */
+      TM_CALLABLE
+      state_t* prepare(uintptr_t h TM_ARG)
+      {
+          state_t* s = TM_READ(state);
+          table_t* old = s->old;
+          if (!old)
+              return s;
+
+          // the last bucket moved in some earlier transaction: drop the old
+          // table
+          if (all_moved(old TM_PARAM)) {
+              state_t* ns = (state_t*)TM_ALLOC(sizeof(state_t));
+              ns->cur = s->cur;
+              ns->old = NULL;
+              TM_WRITE(state, ns);
+              TM_FREE(old);
+              TM_FREE(s);
+              return ns;
+          }
+
+          move(s, h & old->mask TM_PARAM);
+          static __thread uintptr_t cursor = 0;
+          for (int tries = 0; tries < 4; ++tries)
+              if (move(s, cursor++ & old->mask TM_PARAM))
+                  break;
+          return s;
+      }
+
+      /*** start growing, if we are not already */
+      TM_CALLABLE
+      void maybe_grow(state_t* s TM_ARG)
+      {
+          table_t* cur = s->cur;
+          if (s->old || (size() <= 2 * (cur->mask + 1)))
+              return;
+          state_t* ns = (state_t*)TM_ALLOC(sizeof(state_t));
+          ns->cur = new_table(2 * (cur->mask + 1), true);
+          ns->old = cur;
+          TM_WRITE(state, ns);
+          TM_FREE(s);
+      }
+
+    public:
+
+      /*** size is the initial number of buckets, rounded up to a power of 2 */
+      hash_map(uintptr_t size = 64) : state(new state_t()), count(), hash()
+      {
+          uintptr_t n = 1;
+          while (n < size)
+              n <<= 1;
+          state->cur = new_table(n, false);
+          state->old = NULL;
+      }
+
+      /*** not thread safe */
+      ~hash_map()
+      {
+          for (int t = 0; t < 2; ++t) {
+              table_t* tbl = t ? state->old : state->cur;
+              if (!tbl)
+                  continue;
+              for (uintptr_t i = 0; i <= tbl->mask; ++i) {
+                  node_t* n = tbl->buckets[i];
+                  while (n && (n != MOVED())) {
+                      node_t* next = n->next;
+                      free(n);
+                      n = next;
+                  }
+              }
+              free(tbl);
+          }
+          delete state;
+      }
+
+      /*** if key is in the map, copy its value to val */
+      TM_CALLABLE
+      bool lookup(K key, V& val TM_ARG) const
+      {
+          state_t* s = TM_READ(state);
+          uintptr_t h = hash(key);
+          node_t* n = MOVED();
+          if (s->old)
+              n = TM_READ(s->old->buckets[h & s->old->mask]);
+          if (n == MOVED())
+              n = TM_READ(s->cur->buckets[h & s->cur->mask]);
+          n = find(n, key TM_PARAM);
+          if (!n)
+              return false;
+          val = TM_READ(n->val);
+          return true;
+      }
+
+      /*** add key, unless it is already there */
+      TM_CALLABLE
+      bool insert(K key, V val TM_ARG)
+      {
+          uintptr_t h = hash(key);
+          state_t* s = prepare(h TM_PARAM);
+          node_t** b = &s->cur->buckets[h & s->cur->mask];
+          node_t* head = TM_READ(*b);
+          if (find(head, key TM_PARAM))
+              return false;
+          node_t* n = (node_t*)TM_ALLOC(sizeof(node_t));
+          n->key = key;
+          n->val = val;
+          n->next = head;
+          TM_WRITE(*b, n);
+          add(count, 1 TM_PARAM);
+          maybe_grow(s TM_PARAM);
+          return true;
+      }
+
+      /*** change the value of key, if it is there */
+      TM_CALLABLE
+      bool update(K key, V val TM_ARG)
+      {
+          uintptr_t h = hash(key);
+          state_t* s = prepare(h TM_PARAM);
+          node_t* n = find(TM_READ(s->cur->buckets[h & s->cur->mask]), key
+                           TM_PARAM);
+          if (!n)
+              return false;
+          TM_WRITE(n->val, val);
+          return true;
+      }
+
+      TM_CALLABLE
+      bool remove(K key TM_ARG)
+      {
+          uintptr_t h = hash(key);
+          state_t* s = prepare(h TM_PARAM);
+          node_t** prev = &s->cur->buckets[h & s->cur->mask];
+          node_t* n = TM_READ(*prev);
+          while (n && (n->key != key)) {
+              prev = &n->next;
+              n = TM_READ(*prev);
+          }
+          if (!n)
+              return false;
+          TM_WRITE(*prev, TM_READ(n->next));
+          TM_FREE(n);
+          add(count, (uintptr_t)-1 TM_PARAM);
+          return true;
+      }
+
+      /*** the number of elements, as of some recent time */
+      uintptr_t size() const { return peek_sum(count); }
+
+      /**
+       *  Make sure that every element is in the right bucket, and is only in
+       *  the map once.  Not thread safe.
+       */
+      bool isSane() const
+      {
+          uintptr_t seen = 0;
+          for (int t = 0; t < 2; ++t) {
+              table_t* tbl = t ? state->old : state->cur;
+              if (!tbl)
+                  continue;
+              for (uintptr_t i = 0; i <= tbl->mask; ++i) {
+                  for (node_t* n = tbl->buckets[i]; n && (n != MOVED());
+                       n = n->next)
+                  {
+                      if ((hash(n->key) & tbl->mask) != i)
+                          return false;
+                      if (find_plain(n->next, n->key))
+                          return false;
+                      ++seen;
+                  }
+              }
+          }
+          return seen == size();
+      }
+
+    private:
+      static node_t* find_plain(node_t* n, K key)
+      {
+          while (n && (n->key != key))
+              n = n->next;
+          return n;
+      }
+  };
+} // namespace stm
+
+#endif // API_HASH_MAP_HPP__
@@ -22,12 +22,20 @@
  *  TM_BECOME_IRREVOC() : Become irrevocable or abort
  *  TM_READ(var)        : Read from shared memory from a txn
  *  TM_WRITE(var, val)  : Write to shared memory from a txn
- *  TM_BEGIN(type)      : Start a transaction... use 'atomic' as type
+ *  TM_ADD(var, val)    : var += val at commit, without reading var (also
+ *                        TM_MAX, TM_MIN; see stm/deferred.hpp)
+ *  TM_BEGIN(type)      : Start a transaction... use 'atomic' as type.  Each
+ *                        TM_BEGIN is a distinct site for STM_SITES=1
  *  TM_END              : End a transaction
  *
  *  Custom Features:
  *
  *  stm::restart()                : Self-abort and immediately retry a txn
+ *  stm::cancel(tx)               : Roll a txn back without retrying it
+ *  TM_ON_COMMIT(fn, arg)         : Call fn(arg) once the txn commits
+ *  TM_ON_ABORT(fn, arg)          : Call fn(arg) if the txn rolls back
+ *  TM_FPRINTF(f, fmt, ...)       : fprintf, once the txn commits
+ *  TM_FWRITE(buf, len, f)        : fwrite, once the txn commits
  *  TM_BEGIN_FAST_INITIALIZATION  : For fast initialization
  *  TM_END_FAST_INITIALIZATION    : For fast initialization
  *  TM_GET_ALGNAME()              : Get the current algorithm name
@@ -50,12 +58,28 @@
 #define API_LIBRARY_HPP__
 
 #include <setjmp.h>
+#include <cstdio>
 #include <stm/config.h>
 #include <common/platform.hpp>
 #include <stm/txthread.hpp>
+#include <stm/static_dispatch.hpp>
 
 namespace stm
 {
+  /***  Per-atomic-block algorithm selection (STM_SITES=1), in sites.cpp */
+  bool site_begin(TxThread* tx, site_t* site) TM_FASTCALL;
+  void site_commit(TxThread* tx) TM_FASTCALL;
+
+  /***  Barriers for transactions declared read-only, in inst.cpp */
+  void begin_read_only(TxThread* tx);
+  void end_read_only(TxThread* tx);
+
+  /***  Hand commutative updates to the commit, or replay them, in inst.cpp */
+  void commit_deferred(TxThread* tx);
+
+  /*** buffered output takes its place in line to be flushed (txio.cpp) */
+  void txio_ticket(TxThread* tx);
+
   /**
    *  Code to start a transaction.  We assume the caller already performed a
    *  setjmp, and is passing a valid setjmp buffer to this function.
@@ -66,13 +90,21 @@ namespace stm
    *
    *    (a) avoid overhead under subsumption nesting and
    *    (b) avoid code duplication or MACRO nastiness
+   *
+   *  A transaction that promises not to write (TM_BEGIN_READONLY) passes
+   *  read_only, so that it can skip its algorithm's writer checks.  A
+   *  nested transaction is read-only if the outermost one is.
    */
   TM_INLINE
-  inline void begin(TxThread* tx, scope_t* s, uint32_t /*abort_flags*/)
+  inline void begin(TxThread* tx, scope_t* s, uint32_t /*abort_flags*/,
+                    site_t* site = NULL, bool read_only = false)
   {
       if (++tx->nesting_depth > 1)
           return;
 
+      // drop any commutative updates of an aborted attempt
+      tx->deferred.reset();
+
       // we must ensure that the write of the transaction's scope occurs
       // *before* the read of the begin function pointer.  On modern x86, a
       // CAS is faster than using WBR or xchg to achieve the ordering.  On
@@ -88,11 +120,29 @@ namespace stm
       // transactional time.  This code suffices, because it gets the time
       // between transactions.  If we need the time for a single transaction,
       // we can run ProfileTM
+      //
+      // we also note when the transaction first began, so that commit() can
+      // measure its latency, including any aborted attempts
+      uint64_t now = tick();
       if (tx->end_txn_time)
-          tx->total_nontxn_time += (tick() - tx->end_txn_time);
+          tx->total_nontxn_time += (now - tx->end_txn_time);
+      if (!tx->consec_aborts) {
+          tx->txn_start = now;
+          tx->trace.record(now, TRACE_BEGIN, 0);
+      }
 
-      // now call the per-algorithm begin function
-      TxThread::tmbegin(tx);
+      // now call the per-algorithm begin function, or let the atomic block
+      // pick one
+      if (TxThread::site_select) {
+          site_begin(tx, site);
+      }
+      else {
+          tx->site = site; // for the hotspot report
+          TxThread::tmbegin(tx);
+      }
+      if (read_only)
+          begin_read_only(tx);
+      tx->perf.onBegin(tx);
   }
 
   /**
@@ -107,8 +157,25 @@ namespace stm
       if (--tx->nesting_depth)
           return;
 
+      // our commutative updates are done by the algorithm's commit, or go
+      // into the write set now (see deferred.hpp)
+      if (tx->deferred.size())
+          commit_deferred(tx);
+
+      // the commit will reset the logs, so size them for the tracer first
+      uint32_t reads = 0, writes = 0;
+      if (tx->trace.enabled()) {
+          reads = trace_reads(tx);
+          writes = trace_writes(tx);
+      }
+
       // dispatch to the appropriate end function
+      tx->latency.onCommitStart(tx->consec_aborts);
+      if (tx->io)
+          txio_ticket(tx);
       tx->tmcommit(tx);
+      if (tx->read_only)
+          end_read_only(tx);
 
       // zero scope (to indicate "not in tx")
       CFENCE;
@@ -116,6 +183,20 @@ namespace stm
 
       // record start of nontransactional time
       tx->end_txn_time = tick();
+      tx->total_txn_time += tx->end_txn_time - tx->txn_start;
+      tx->latency.onCommitEnd(tx->txn_start, tx->end_txn_time);
+      tx->perf.onCommit();
+      tx->trace.record(tx->end_txn_time, TRACE_COMMIT, 0, reads, writes);
+      if (TxThread::site_select)
+          site_commit(tx);
+
+      // last, run the on_commit() handlers, in the order they were added
+      if (tx->commit_handlers.size()) {
+          foreach (HandlerList, i, tx->commit_handlers)
+              i->fn(i->arg);
+          tx->commit_handlers.reset();
+      }
+      tx->abort_handlers.reset();
   }
 
   /**
@@ -211,6 +292,40 @@ namespace stm
    *  Abort the current transaction and restart immediately.
    */
   void restart();
+
+  /**
+   *  Roll the current transaction back, without restarting it (for
+   *  exceptions that escape stm::atomic()).  Returns false if the
+   *  transaction is irrevocable, and so can only commit.
+   */
+  bool cancel(TxThread* tx);
+}
+
+namespace stm
+{
+  /**
+   *  The word barriers that DISPATCH calls.  In a static-dispatch build, they
+   *  are the one algorithm's own, and inline (see static_dispatch.hpp).
+   */
+  TM_INLINE
+  inline void* tmread_barrier(STM_READ_SIG(tx,addr,mask))
+  {
+#ifdef STM_STATIC_DISPATCH
+      return static_read(tx, addr STM_MASK(mask));
+#else
+      return tx->tmread(tx, addr STM_MASK(mask));
+#endif
+  }
+
+  TM_INLINE
+  inline void tmwrite_barrier(STM_WRITE_SIG(tx,addr,val,mask))
+  {
+#ifdef STM_STATIC_DISPATCH
+      static_write(tx, addr, val STM_MASK(mask));
+#else
+      tx->tmwrite(tx, addr, val STM_MASK(mask));
+#endif
+  }
 }
 
 /*** pull in the per-memory-access instrumentation framework */
@@ -225,21 +340,207 @@ namespace stm
   template <typename T>
   inline T stm_read(T* addr, TxThread* thread)
   {
+#ifdef STM_CAPTURE_YES
+      if (thread->allocator.captured(addr, sizeof(T)))
+          return *addr;
+#endif
       return DISPATCH<T, sizeof(T)>::read(addr, thread);
   }
 
   template <typename T>
   inline void stm_write(T* addr, T val, TxThread* thread)
   {
+#ifdef STM_CAPTURE_YES
+      if (thread->allocator.captured(addr, sizeof(T))) {
+          *addr = val;
+          return;
+      }
+#endif
       DISPATCH<T, sizeof(T)>::write(addr, val, thread);
   }
 } // namespace stm
 
+namespace stm
+{
+  /**
+   *  Bulk versions of stm_read and stm_write, for copying whole structs and
+   *  arrays in and out of shared memory with one call instead of one per
+   *  field.  stm_read_range copies len bytes of shared memory at src to the
+   *  private buffer dst, stm_write_range does the opposite, and stm_memcpy
+   *  copies between two shared, non-overlapping ranges.  There are no
+   *  alignment requirements (see range.cpp).
+   */
+  void stm_read_range(void* dst, const void* src, size_t len, TxThread* tx);
+  void stm_write_range(void* dst, const void* src, size_t len, TxThread* tx);
+  void stm_memcpy(void* dst, const void* src, size_t len, TxThread* tx);
+} // namespace stm
+
+namespace stm
+{
+  /**
+   *  Transactional output.  Inside a transaction, stm_fwrite and stm_fprintf
+   *  buffer their output, which is written once the transaction commits, in
+   *  commit order, and dropped if it aborts, so that a transaction can log
+   *  without becoming irrevocable (see txio.cpp).  By the time the
+   *  transaction's TM_END returns, its output has been passed to fwrite, so
+   *  output that the thread produces afterward comes after it.  Outside of
+   *  a transaction, they are fwrite and fprintf.
+   */
+  void stm_fwrite(const void* buf, size_t len, FILE* f, TxThread* tx);
+  void stm_fprintf(TxThread* tx, FILE* f, const char* fmt, ...);
+} // namespace stm
+
+namespace stm
+{
+  /**
+   *  Commutative updates: *addr = OP(*addr, val), done at commit without
+   *  reading *addr through the barriers, when the algorithm allows (see
+   *  deferred.hpp).  Outside of a transaction, the update happens right
+   *  away.  The operand is converted to the location's type, as with +=.
+   */
+  template <typename T, class OP>
+  struct deferred_replay
+  {
+      static void replay(void* addr, uint64_t val, TxThread* tx)
+      {
+          T* a = (T*)addr;
+          stm_write(a, OP::op(stm_read(a, tx), deferred<T, OP>::unpack(val)),
+                    tx);
+      }
+  };
+
+  template <typename T, class OP>
+  inline void stm_defer(T* addr, T val, TxThread* thread)
+  {
+      if (!thread->nesting_depth) {
+          deferred<T, OP>::apply(addr, deferred<T, OP>::pack(val));
+          return;
+      }
+      deferred_op_t op;
+      op.addr  = addr;
+      op.update = deferred<T, OP>::update;
+      op.replay = deferred_replay<T, OP>::replay;
+      op.val   = deferred<T, OP>::pack(val);
+      thread->deferred.insert(op);
+  }
+
+  /**
+   *  Handlers: on_commit(fn, arg) calls fn(arg) after the transaction
+   *  commits, and on_abort(fn, arg) calls it each time the transaction rolls
+   *  back, after its writes have been undone.  A handler runs outside of the
+   *  transaction, and must not begin a transaction of its own.  Outside of a
+   *  transaction, on_commit calls fn right away, and on_abort does nothing.
+   */
+  inline void on_commit(void (*fn)(void*), void* arg, TxThread* thread)
+  {
+      if (!thread->nesting_depth) {
+          fn(arg);
+          return;
+      }
+      handler_t h = { fn, arg };
+      thread->commit_handlers.insert(h);
+  }
+
+  inline void on_abort(void (*fn)(void*), void* arg, TxThread* thread)
+  {
+      if (!thread->nesting_depth)
+          return;
+      handler_t h = { fn, arg };
+      thread->abort_handlers.insert(h);
+  }
+
+  template <typename T, typename V>
+  inline void stm_add(T* addr, V val, TxThread* thread)
+  {
+      stm_defer<T, deferred_add>(addr, (T)val, thread);
+  }
+
+  template <typename T, typename V>
+  inline void stm_max(T* addr, V val, TxThread* thread)
+  {
+      stm_defer<T, deferred_max>(addr, (T)val, thread);
+  }
+
+  template <typename T, typename V>
+  inline void stm_min(T* addr, V val, TxThread* thread)
+  {
+      stm_defer<T, deferred_min>(addr, (T)val, thread);
+  }
+} // namespace stm
+
 /**
  * Code should only use these calls, not the template stuff declared above
  */
 #define TM_READ(var)       stm::stm_read(&var, tx)
 #define TM_WRITE(var, val) stm::stm_write(&var, val, tx)
+#define TM_ADD(var, val)   stm::stm_add(&var, val, tx)
+#define TM_MAX(var, val)   stm::stm_max(&var, val, tx)
+#define TM_MIN(var, val)   stm::stm_min(&var, val, tx)
+#define TM_ON_COMMIT(fn, arg) stm::on_commit(fn, arg, tx)
+#define TM_ON_ABORT(fn, arg)  stm::on_abort(fn, arg, tx)
+#define TM_FWRITE(buf, len, f) stm::stm_fwrite(buf, len, f, tx)
+#define TM_FPRINTF(f, ...)     stm::stm_fprintf(tx, f, __VA_ARGS__)
+#define TM_READ_RANGE(dst, src, len)  stm::stm_read_range(dst, src, len, tx)
+#define TM_WRITE_RANGE(dst, src, len) stm::stm_write_range(dst, src, len, tx)
+#define TM_MEMCPY(dst, src, len)      stm::stm_memcpy(dst, src, len, tx)
+
+#if __cplusplus >= 201103L
+namespace stm
+{
+  /**
+   *  A C++11 alternative to TM_BEGIN/TM_END, which doesn't pay for a setjmp
+   *  on every transaction:
+   *
+   *      stm::atomic([&](stm::TxThread* tx) {
+   *          TM_WRITE(x, 1 + TM_READ(x));
+   *      });
+   *
+   *  The transaction's scope is atomic_scope, so the default abort handler
+   *  throws an atomic_restart, which the loop below catches before it tries
+   *  again.  That makes aborts slower, and needs the default abort handler
+   *  (i.e., sys_init() without one).  Unlike with setjmp, locals that the
+   *  body modifies keep their values across an abort, so the body should
+   *  set them up itself.  Any other exception that escapes the body rolls
+   *  the transaction back (or commits it, if it became irrevocable) on its
+   *  way out.
+   */
+  template <class F>
+  inline void atomic(F&& body)
+  {
+      TxThread* tx = (TxThread*)Self;
+
+      // subsumption nesting: the outermost transaction handles restarts
+      if (tx->nesting_depth) {
+          body(tx);
+          return;
+      }
+
+      // one site per lambda, since each lambda has its own type
+      static site_t site;
+      while (true) {
+          try {
+              begin(tx, &atomic_scope, 0, &site);
+              CFENCE;
+              body(tx);
+              commit(tx);
+              return;
+          }
+          catch (atomic_restart&) { }
+          catch (...) {
+              // any other exception leaves the transaction.  Rolling back
+              // resets nesting_depth and the scope and releases our locks;
+              // an irrevocable transaction has done its writes, so it
+              // commits instead.
+              if (!cancel(tx)) {
+                  tx->nesting_depth = 1;
+                  commit(tx);
+              }
+              throw;
+          }
+      }
+  }
+} // namespace stm
+#endif
 
 /**
  *  This is the way to start a transaction
@@ -247,9 +548,24 @@ namespace stm
 #define TM_BEGIN(TYPE)                                      \
     {                                                       \
     stm::TxThread* tx = (stm::TxThread*)stm::Self;          \
+    static stm::site_t _site;                               \
     jmp_buf _jmpbuf;                                        \
     uint32_t abort_flags = setjmp(_jmpbuf);                 \
-    stm::begin(tx, &_jmpbuf, abort_flags);                  \
+    stm::begin(tx, &_jmpbuf, abort_flags, &_site);          \
+    CFENCE;                                                 \
+    {
+
+/**
+ *  This is the way to start a transaction that does not write.  If it
+ *  writes anyway, it still works, but is counted at shutdown.
+ */
+#define TM_BEGIN_READONLY()                                 \
+    {                                                       \
+    stm::TxThread* tx = (stm::TxThread*)stm::Self;          \
+    static stm::site_t _site;                               \
+    jmp_buf _jmpbuf;                                        \
+    uint32_t abort_flags = setjmp(_jmpbuf);                 \
+    stm::begin(tx, &_jmpbuf, abort_flags, &_site, true);    \
     CFENCE;                                                 \
     {
 
@@ -281,7 +597,7 @@ namespace stm
 #define TM_ALLOC             stm::tx_alloc
 #define TM_FREE              stm::tx_free
 #define TM_SET_POLICY(P)     stm::set_policy(P)
-#define TM_BECOME_IRREVOC()  stm::becom_irrevoc()
+#define TM_BECOME_IRREVOC()  stm::become_irrevoc()
 #define TM_GET_ALGNAME()     stm::get_algname()
 
 /**
@@ -304,6 +620,12 @@ namespace stm
 #ifdef STM_API_ITM
 #  define TM_BEGIN_FAST_INITIALIZATION()
 #  define TM_END_FAST_INITIALIZATION()
+#elif defined(STM_STATIC_DISPATCH)
+#  define TM_BEGIN_FAST_INITIALIZATION()                \
+    TM_GET_THREAD();                                    \
+    stm::static_fast_initialization(tx, true)
+#  define TM_END_FAST_INITIALIZATION()                  \
+    stm::static_fast_initialization(tx, false)
 #else
 #  define TM_BEGIN_FAST_INITIALIZATION()                \
     const char* __config_string__ = TM_GET_ALGNAME();   \
@@ -11,6 +11,7 @@
 #ifndef API_LIBRARY_INST_HPP__
 #define API_LIBRARY_INST_HPP__
 
+#include <cstring>
 #include <stm/config.h>
 
 /**
@@ -24,8 +25,8 @@
  *  This file presents those templates, to reduce clutter in the main
  *  library.hpp file.
  *
- *  This file should be included in the middle of the library file.  It has no
- *  includes of its own.
+ *  This file should be included in the middle of the library file.  It only
+ *  includes <cstring>, for copying two-word types in and out of words.
  *
  *  Also, BE WARNED: this implementation of the library API allows "granular
  *  lost updates".  If transaction A writes a single char, and thread B writes
@@ -50,8 +51,8 @@ namespace stm
 
       // the read method will transform a read to a sizeof(T) byte range
       // starting at addr into a set of stmread_word calls.  For now, the
-      // range must be aligned on a sizeof(T) boundary, and T must be 1, 4,
-      // or 8 bytes.
+      // range must be aligned on a sizeof(T) boundary (or on a word
+      // boundary, for 16-byte types), and T must be 1, 4, 8, or 16 bytes.
       TM_INLINE
       static T read(T* addr, TxThread* thread)
       {
@@ -77,14 +78,14 @@ namespace stm
       TM_INLINE
       static T read(T* addr, TxThread* thread)
       {
-          return (T)(uintptr_t)thread->tmread(thread, (void**)addr
+          return (T)(uintptr_t)tmread_barrier(thread, (void**)addr
                                               STM_MASK(~0x0));
       }
 
       TM_INLINE
       static void write(T* addr, T val, TxThread* thread)
       {
-          thread->tmwrite(thread, (void**)addr, (void*)(uintptr_t)val
+          tmwrite_barrier(thread, (void**)addr, (void*)(uintptr_t)val
                           STM_MASK(~0x0));
       }
   };
@@ -97,7 +98,7 @@ namespace stm
       static float read(float* addr, TxThread* thread)
       {
           union { float f;  void* v;  } v;
-          v.v = thread->tmread(thread, (void**)addr STM_MASK(~0x0));
+          v.v = tmread_barrier(thread, (void**)addr STM_MASK(~0x0));
           return v.f;
       }
 
@@ -106,7 +107,7 @@ namespace stm
       {
           union { float f;  void* v;  } v;
           v.f = val;
-          thread->tmwrite(thread, (void**)addr, v.v STM_MASK(~0x0));
+          tmwrite_barrier(thread, (void**)addr, v.v STM_MASK(~0x0));
       }
   };
 
@@ -118,7 +119,7 @@ namespace stm
       static float read(const float* addr, TxThread* thread)
       {
           union { float f;  void* v;  } v;
-          v.v = thread->tmread(thread, (void**)addr STM_MASK(~0x0));
+          v.v = tmread_barrier(thread, (void**)addr STM_MASK(~0x0));
           return v.f;
       }
 
@@ -143,8 +144,8 @@ namespace stm
               struct { void* v1; void* v2; } v;
           } v;
           // read the two words
-          v.v.v1 = thread->tmread(thread, (void**)addr STM_MASK(~0x0));
-          v.v.v2 = thread->tmread(thread, addr2 STM_MASK(~0x0));
+          v.v.v1 = tmread_barrier(thread, (void**)addr STM_MASK(~0x0));
+          v.v.v2 = tmread_barrier(thread, addr2 STM_MASK(~0x0));
           return (T)v.l;
       }
 
@@ -161,8 +162,8 @@ namespace stm
           } v;
           v.t = val;
           // write the two words
-          thread->tmwrite(thread, addr1, v.v.v1 STM_MASK(~0x0));
-          thread->tmwrite(thread, addr2, v.v.v2 STM_MASK(~0x0));
+          tmwrite_barrier(thread, addr1, v.v.v1 STM_MASK(~0x0));
+          tmwrite_barrier(thread, addr2, v.v.v2 STM_MASK(~0x0));
       }
   };
 
@@ -183,8 +184,8 @@ namespace stm
               struct { void* v1; void* v2; } v;
           } v;
           // read the two words
-          v.v.v1 = thread->tmread(thread, (void**)addr STM_MASK(~0x0));
-          v.v.v2 = thread->tmread(thread, addr2 STM_MASK(~0x0));
+          v.v.v1 = tmread_barrier(thread, (void**)addr STM_MASK(~0x0));
+          v.v.v2 = tmread_barrier(thread, addr2 STM_MASK(~0x0));
           return v.t;
       }
 
@@ -201,8 +202,8 @@ namespace stm
           } v;
           v.t = val;
           // write the two words
-          thread->tmwrite(thread, addr1, v.v.v1 STM_MASK(~0x0));
-          thread->tmwrite(thread, addr2, v.v.v2 STM_MASK(~0x0));
+          tmwrite_barrier(thread, addr1, v.v.v1 STM_MASK(~0x0));
+          tmwrite_barrier(thread, addr2, v.v.v2 STM_MASK(~0x0));
       }
   };
 
@@ -220,8 +221,8 @@ namespace stm
               struct { void* v1; void* v2; } v;
           } v;
           // read the two words
-          v.v.v1 = thread->tmread(thread, (void**)addr STM_MASK(~0x0));
-          v.v.v2 = thread->tmread(thread, addr2 STM_MASK(~0x0));
+          v.v.v1 = tmread_barrier(thread, (void**)addr STM_MASK(~0x0));
+          v.v.v2 = tmread_barrier(thread, addr2 STM_MASK(~0x0));
           return v.t;
       }
 
@@ -252,7 +253,7 @@ namespace stm
           union { char v[4]; void* v2; } v;
           void** a = (void**)(((long)addr) & ~3);
           long offset = ((long)addr) & 3;
-          v.v2 = thread->tmread(thread, a STM_MASK(0xFF << (8 * offset)));
+          v.v2 = tmread_barrier(thread, a STM_MASK(0xFF << (8 * offset)));
           return (T)v.v[offset];
       }
 
@@ -265,9 +266,9 @@ namespace stm
           void** a = (void**)(((long)addr) & ~3);
           long offset = ((long)addr) & 3;
           // read the enclosing word
-          v.v2 = thread->tmread(thread, a STM_MASK(0xFF << (8 * offset)));
+          v.v2 = tmread_barrier(thread, a STM_MASK(0xFF << (8 * offset)));
           v.v[offset] = val;
-          thread->tmwrite(thread, a, v.v2 STM_MASK(0xFF << (8 * offset)));
+          tmwrite_barrier(thread, a, v.v2 STM_MASK(0xFF << (8 * offset)));
       }
   };
 
@@ -279,14 +280,14 @@ namespace stm
       TM_INLINE
       static T read(T* addr, TxThread* thread)
       {
-          return (T)(uintptr_t)thread->tmread(thread, (void**)addr
+          return (T)(uintptr_t)tmread_barrier(thread, (void**)addr
                                               STM_MASK(~0x0));
       }
 
       TM_INLINE
       static void write(T* addr, T val, TxThread* thread)
       {
-          thread->tmwrite(thread, (void**)addr, (void*)(uintptr_t)val
+          tmwrite_barrier(thread, (void**)addr, (void*)(uintptr_t)val
                           STM_MASK(~0x0));
       }
   };
@@ -299,7 +300,7 @@ namespace stm
       static double read(double* addr, TxThread* thread)
       {
           union { double d;  void*  v; } v;
-          v.v = thread->tmread(thread, (void**)addr STM_MASK(~0x0));
+          v.v = tmread_barrier(thread, (void**)addr STM_MASK(~0x0));
           return v.d;
       }
 
@@ -308,7 +309,7 @@ namespace stm
       {
           union { double d;  void*  v; } v;
           v.d = val;
-          thread->tmwrite(thread, (void**)addr, v.v STM_MASK(~0x0));
+          tmwrite_barrier(thread, (void**)addr, v.v STM_MASK(~0x0));
       }
   };
 
@@ -320,7 +321,7 @@ namespace stm
       static double read(const double* addr, TxThread* thread)
       {
           union { double d;  void*  v; } v;
-          v.v = thread->tmread(thread, (void**)addr STM_MASK(~0x0));
+          v.v = tmread_barrier(thread, (void**)addr STM_MASK(~0x0));
           return v.d;
       }
 
@@ -331,43 +332,57 @@ namespace stm
       }
   };
 
-  /*** specialization for long-double */
-  template <>
-  struct DISPATCH<long double, 16>
+  /**
+   *  16-byte types (long double, __int128, __m128i, pointer+tag pairs) are
+   *  two word barriers.  The type must be word aligned.
+   */
+  template <typename T>
+  struct DISPATCH_PAIR
   {
       TM_INLINE
-      static double read(double* addr, TxThread* thread)
+      static T read(T* addr, TxThread* thread)
       {
-          // get second word's address
-          void** addr2 = (void**)((long)addr + 4);
-          union {
-              double t;
-              struct { void* v1; void* v2; } v;
-          } v;
-          // read the two words
-          v.v.v1 = thread->tmread(thread, (void**)addr STM_MASK(~0x0));
-          v.v.v2 = thread->tmread(thread, addr2 STM_MASK(~0x0));
-          return v.t;
+          void* v[2];
+          v[0] = tmread_barrier(thread, (void**)addr STM_MASK(~0x0));
+          v[1] = tmread_barrier(thread, (void**)addr + 1 STM_MASK(~0x0));
+          T t;
+          memcpy(&t, v, sizeof(T));
+          return t;
       }
 
       TM_INLINE
-      static void write(double* addr, double val, TxThread* thread)
+      static void write(T* addr, T val, TxThread* thread)
       {
-          // compute the two addresses
-          void** addr1 = (void**) addr;
-          void** addr2 = (void**) ((long)addr + 4);
-          // turn the value into two words
-          union {
-              double t;
-              struct { void* v1; void* v2; } v;
-          } v;
-          v.t = val;
-          // write the two words
-          thread->tmwrite(thread, addr1, v.v.v1 STM_MASK(~0x0));
-          thread->tmwrite(thread, addr2, v.v.v2 STM_MASK(~0x0));
+          void* v[2];
+          memcpy(v, &val, sizeof(T));
+          tmwrite_barrier(thread, (void**)addr, v[0] STM_MASK(~0x0));
+          tmwrite_barrier(thread, (void**)addr + 1, v[1] STM_MASK(~0x0));
+      }
+  };
+
+  /*** the same, for const types, which can only be read */
+  template <typename T>
+  struct DISPATCH_CONST_PAIR
+  {
+      TM_INLINE
+      static T read(const T* addr, TxThread* thread)
+      {
+          return DISPATCH_PAIR<T>::read((T*)addr, thread);
+      }
+
+      TM_INLINE
+      static void write(const T*, T, TxThread*)
+      {
+          UNRECOVERABLE("You should not be writing a const type!");
       }
   };
 
+  template <typename T>
+  struct DISPATCH<T, 16> : DISPATCH_PAIR<T> { };
+
+  template <typename T>
+  struct DISPATCH<const T, 16> : DISPATCH_CONST_PAIR<T> { };
+
   /**
    *  Since 4-byte types are sub-word, and since we do everything at the
    *  granularity of words, we need to do some careful work to make a 4-byte
@@ -393,7 +408,7 @@ namespace stm
           union { int v[2]; void* v2; } v;
           void** a = (void**)(((intptr_t)addr) & ~7ul);
           long offset = (((intptr_t)addr)>>2)&1;
-          v.v2 = thread->tmread(thread, a
+          v.v2 = tmread_barrier(thread, a
                                 STM_MASK(0xffffffff << (32 * offset)));
           return (T)v.v[offset];
       }
@@ -407,10 +422,10 @@ namespace stm
           void** a = (void**)(((intptr_t)addr) & ~7ul);
           int offset = (((intptr_t)addr)>>2) & 1;
           // read the enclosing word
-          v.v2 = thread->tmread(thread, a
+          v.v2 = tmread_barrier(thread, a
                                 STM_MASK(0xffffffff << (32 * offset)));
           v.v[offset] = val;
-          thread->tmwrite(thread, a, v.v2
+          tmwrite_barrier(thread, a, v.v2
                           STM_MASK(0xffffffff << (32 * offset)));
       }
   };
@@ -426,7 +441,7 @@ namespace stm
           union { float v[2]; void* v2; } v;
           void** a = (void**)(((intptr_t)addr)&~7ul);
           long offset = (((intptr_t)addr)>>2)&1;
-          v.v2 = thread->tmread(thread, a
+          v.v2 = tmread_barrier(thread, a
                                 STM_MASK(0xffffffff << (32 * offset)));
           return v.v[offset];
       }
@@ -439,10 +454,10 @@ namespace stm
           void**a = (void**)(((intptr_t)addr) & ~7ul);
           int offset = (((intptr_t)addr)>>2) & 1;
           // read enclosing word
-          v.v2 = thread->tmread(thread, a
+          v.v2 = tmread_barrier(thread, a
                                 STM_MASK(0xffffffff << (32 * offset)));
           v.v[offset] = val;
-          thread->tmwrite(thread, a, v.v2
+          tmwrite_barrier(thread, a, v.v2
                           STM_MASK(0xffffffff << (32 * offset)));
       }
   };
@@ -458,7 +473,7 @@ namespace stm
           union { float v[2]; void* v2; } v;
           void** a = (void**)(((intptr_t)addr)&~7ul);
           long offset = (((intptr_t)addr)>>2)&1;
-          v.v2 = thread->tmread(thread, a
+          v.v2 = tmread_barrier(thread, a
                                 STM_MASK(0xffffffff << (32 * offset)));
           return v.v[offset];
       }
@@ -483,7 +498,7 @@ namespace stm
           union { char v[8]; void* v2; } v;
           void** a = (void**)(((long)addr) & ~7);
           long offset = ((long)addr) & 7;
-          v.v2 = thread->tmread(thread, a
+          v.v2 = tmread_barrier(thread, a
                                 STM_MASK(0xffffffff << (8 * offset)));
           return (T)v.v[offset];
       }
@@ -497,10 +512,10 @@ namespace stm
           void** a = (void**)(((long)addr) & ~7);
           long offset = ((long)addr) & 7;
           // read the enclosing word
-          v.v2 = thread->tmread(thread, a
+          v.v2 = tmread_barrier(thread, a
                                 STM_MASK(0xffffffff << (8 * offset)));
           v.v[offset] = val;
-          thread->tmwrite(thread, a, v.v2
+          tmwrite_barrier(thread, a, v.v2
                           STM_MASK(0xffffffff << (8 * offset)));
       }
   };
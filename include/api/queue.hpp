@@ -0,0 +1,112 @@
+/**
+ *  Copyright (C) 2011
+ *  University of Rochester Department of Computer Science
+ *    and
+ *  Lehigh University Department of Computer Science and Engineering
+ *
+ * License: Modified BSD
+ *          Please see the file LICENSE.RSTM for licensing information
+ */
+
+/**
+ *  stm::bounded_queue is a transactional FIFO queue with a fixed capacity
+ *  (see containers.hpp for what all of the containers have in common).
+ *
+ *  A push only reads and writes the tail index and the tail slot, and a pop
+ *  only the head index and the head slot: each slot says whether it is
+ *  full, so neither end has to read the other end's index to see if the
+ *  queue is full or empty.  Producers conflict with producers and consumers
+ *  with consumers, as they must, but producers and consumers only conflict
+ *  when the queue is (nearly) empty or full.
+ */
+
+#ifndef API_QUEUE_HPP__
+#define API_QUEUE_HPP__
+
+#include <cstdlib>
+#include <api/api.hpp>
+
+namespace stm
+{
+  template <typename T>
+  class bounded_queue
+  {
+      struct slot_t
+      {
+          T         val;
+          uintptr_t full;
+      };
+
+      slot_t*   slots;
+      uintptr_t mask;           // capacity - 1; never changes
+      char      pad1[CACHELINE_BYTES];
+      uintptr_t head;           // next slot to pop
+      char      pad2[CACHELINE_BYTES];
+      uintptr_t tail;           // next slot to push
+      char      pad3[CACHELINE_BYTES];
+
+    public:
+
+      /*** capacity is rounded up to a power of 2 */
+      bounded_queue(uintptr_t capacity = 1024) : head(0), tail(0)
+      {
+          uintptr_t n = 1;
+          while (n < capacity)
+              n <<= 1;
+          mask = n - 1;
+          slots = (slot_t*)calloc(n, sizeof(slot_t));
+      }
+
+      /*** not thread safe */
+      ~bounded_queue() { free(slots); }
+
+      /*** add val at the tail, unless the queue is full */
+      TM_CALLABLE
+      bool push(T val TM_ARG)
+      {
+          uintptr_t t = TM_READ(tail);
+          slot_t* s = &slots[t & mask];
+          if (TM_READ(s->full))
+              return false;
+          TM_WRITE(s->val, val);
+          TM_WRITE(s->full, (uintptr_t)1);
+          TM_WRITE(tail, t + 1);
+          return true;
+      }
+
+      /*** take the value at the head, unless the queue is empty */
+      TM_CALLABLE
+      bool pop(T& val TM_ARG)
+      {
+          uintptr_t h = TM_READ(head);
+          slot_t* s = &slots[h & mask];
+          if (!TM_READ(s->full))
+              return false;
+          val = TM_READ(s->val);
+          TM_WRITE(s->full, (uintptr_t)0);
+          TM_WRITE(head, h + 1);
+          return true;
+      }
+
+      uintptr_t capacity() const { return mask + 1; }
+
+      /**
+       *  Make sure that exactly the slots between head and tail are full.
+       *  Not thread safe.
+       */
+      bool isSane() const
+      {
+          if (tail - head > mask + 1)
+              return false;
+          for (uintptr_t i = 0; i <= mask; ++i) {
+              bool inside = ((i - head) & mask) < tail - head;
+              if ((tail - head == mask + 1) ? !slots[i].full
+                                            : (inside != !!slots[i].full))
+                  return false;
+          }
+          return true;
+      }
+  };
+} // namespace stm
+
+#endif // API_QUEUE_HPP__
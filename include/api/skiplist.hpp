@@ -0,0 +1,210 @@
+/**
+ *  Copyright (C) 2011
+ *  University of Rochester Department of Computer Science
+ *    and
+ *  Lehigh University Department of Computer Science and Engineering
+ *
+ * License: Modified BSD
+ *          Please see the file LICENSE.RSTM for licensing information
+ */
+
+/**
+ *  stm::skiplist_map is a transactional ordered map (see containers.hpp for
+ *  what all of the containers have in common).
+ *
+ *  A search reads O(log n) links, instead of the O(n) of a sorted list, and
+ *  an insert or remove only writes the links into and out of its node, so
+ *  updates in different parts of the key space don't conflict.  A node's
+ *  height comes from the hash of its key (one more level for each pair of
+ *  trailing zero bits, so 1/4 of the nodes at each level go up to the next),
+ *  which needs no random number state in the transaction.
+ */
+
+#ifndef API_SKIPLIST_HPP__
+#define API_SKIPLIST_HPP__
+
+#include <cstdlib>
+#include <api/api.hpp>
+#include <api/container_hash.hpp>
+
+namespace stm
+{
+  template <typename K, typename V, class H = container_hash<K> >
+  class skiplist_map
+  {
+      static const int MAX_LEVEL = 12;  // enough for 4^12 elements
+
+      struct node_t
+      {
+          K         key;        // never changes once the node is in the map
+          V         val;
+          uintptr_t height;     // never changes
+          node_t*   next[1];    // really next[height]
+      };
+
+      node_t* head;             // height MAX_LEVEL, no key
+      H       hash;
+
+      int height_of(K key) const
+      {
+          uintptr_t h = hash(key);
+          int height = 1;
+          while ((height < MAX_LEVEL) && !(h & 3)) {
+              ++height;
+              h >>= 2;
+          }
+          return height;
+      }
+
+      static node_t* new_node(int height, bool in_tx)
+      {
+          size_t bytes = sizeof(node_t) + (height - 1) * sizeof(node_t*);
+          node_t* n = (node_t*)(in_tx ? TM_ALLOC(bytes) : malloc(bytes));
+          n->height = height;
+          return n;
+      }
+
+      /**
+       *  Find the last node before key at each level (in preds), and return
+       *  the node after it at level 0.  Keys are read without barriers, since
+       *  they never change, and the link we followed to get there is in the
+       *  read set.
+       */
+      TM_CALLABLE
+      node_t* search(K key, node_t** preds TM_ARG) const
+      {
+          node_t* pred = head;
+          node_t* curr = NULL;
+          for (int l = MAX_LEVEL - 1; l >= 0; --l) {
+              curr = TM_READ(pred->next[l]);
+              while (curr && (curr->key < key)) {
+                  pred = curr;
+                  curr = TM_READ(pred->next[l]);
+              }
+              if (preds)
+                  preds[l] = pred;
+          }
+          return curr;
+      }
+
+    public:
+
+      skiplist_map() : head(new_node(MAX_LEVEL, false)), hash()
+      {
+          for (int l = 0; l < MAX_LEVEL; ++l)
+              head->next[l] = NULL;
+      }
+
+      /*** not thread safe */
+      ~skiplist_map()
+      {
+          node_t* n = head;
+          while (n) {
+              node_t* next = n->next[0];
+              free(n);
+              n = next;
+          }
+      }
+
+      /*** if key is in the map, copy its value to val */
+      TM_CALLABLE
+      bool lookup(K key, V& val TM_ARG) const
+      {
+          node_t* n = search(key, NULL TM_PARAM);
+          if (!n || (n->key != key))
+              return false;
+          val = TM_READ(n->val);
+          return true;
+      }
+
+      /*** add key, unless it is already there */
+      TM_CALLABLE
+      bool insert(K key, V val TM_ARG)
+      {
+          node_t* preds[MAX_LEVEL];
+          node_t* n = search(key, preds TM_PARAM);
+          if (n && (n->key == key))
+              return false;
+
+          int height = height_of(key);
+          n = new_node(height, true);
+          n->key = key;
+          n->val = val;
+          for (int l = 0; l < height; ++l) {
+              n->next[l] = TM_READ(preds[l]->next[l]);
+              TM_WRITE(preds[l]->next[l], n);
+          }
+          return true;
+      }
+
+      /*** change the value of key, if it is there */
+      TM_CALLABLE
+      bool update(K key, V val TM_ARG)
+      {
+          node_t* n = search(key, NULL TM_PARAM);
+          if (!n || (n->key != key))
+              return false;
+          TM_WRITE(n->val, val);
+          return true;
+      }
+
+      TM_CALLABLE
+      bool remove(K key TM_ARG)
+      {
+          node_t* preds[MAX_LEVEL];
+          node_t* n = search(key, preds TM_PARAM);
+          if (!n || (n->key != key))
+              return false;
+          for (int l = 0; l < (int)n->height; ++l)
+              TM_WRITE(preds[l]->next[l], TM_READ(n->next[l]));
+          TM_FREE(n);
+          return true;
+      }
+
+      /*** the smallest key, if the map isn't empty */
+      TM_CALLABLE
+      bool first(K& key TM_ARG) const
+      {
+          node_t* n = TM_READ(head->next[0]);
+          if (!n)
+              return false;
+          key = n->key;
+          return true;
+      }
+
+      /**
+       *  Make sure that each level is sorted, and only skips nodes that are
+       *  too short for it.  Not thread safe.
+       */
+      bool isSane() const
+      {
+          for (int l = 0; l < MAX_LEVEL; ++l) {
+              node_t* n = head->next[l];
+              node_t* lower = head->next[0];
+              while (n) {
+                  if ((int)n->height <= l)
+                      return false;
+                  if (n->next[l] && !(n->key < n->next[l]->key))
+                      return false;
+                  // every node between here and the next one at this level
+                  // must be shorter than l + 1
+                  while (lower && (lower->key < n->key)) {
+                      if ((int)lower->height > l)
+                          return false;
+                      lower = lower->next[0];
+                  }
+                  if (lower != n)
+                      return false;
+                  lower = lower->next[0];
+                  n = n->next[l];
+              }
+              for (; lower; lower = lower->next[0])
+                  if ((int)lower->height > l)
+                      return false;
+          }
+          return true;
+      }
+  };
+} // namespace stm
+
+#endif // API_SKIPLIST_HPP__
@@ -63,9 +63,11 @@ inline void tx_safe_non_tx_free(void * ptr)
  */
 #define STM_BEGIN_WR()                                                  \
     {                                                                   \
+    static stm::site_t site_;                                           \
     jmp_buf jmpbuf_;                                                    \
     uint32_t abort_flags = setjmp(jmpbuf_);                             \
-    begin(static_cast<stm::TxThread*>(STM_SELF), &jmpbuf_, abort_flags);\
+    begin(static_cast<stm::TxThread*>(STM_SELF), &jmpbuf_, abort_flags, \
+          &site_);                                                      \
     CFENCE;                                                             \
     {
 
@@ -74,8 +76,15 @@ inline void tx_safe_non_tx_free(void * ptr)
     commit(static_cast<stm::TxThread*>(STM_SELF));  \
     }
 
-/*** read-only begin == read/write begin */
-#define STM_BEGIN_RD() STM_BEGIN_WR()
+#define STM_BEGIN_RD()                                                  \
+    {                                                                   \
+    static stm::site_t site_;                                           \
+    jmp_buf jmpbuf_;                                                    \
+    uint32_t abort_flags = setjmp(jmpbuf_);                             \
+    begin(static_cast<stm::TxThread*>(STM_SELF), &jmpbuf_, abort_flags, \
+          &site_, true);                                                \
+    CFENCE;                                                             \
+    {
 
 /**
  *  tm_main_startup()
@@ -0,0 +1,153 @@
+/**
+ *  Copyright (C) 2011
+ *  University of Rochester Department of Computer Science
+ *    and
+ *  Lehigh University Department of Computer Science and Engineering
+ *
+ * License: Modified BSD
+ *          Please see the file LICENSE.RSTM for licensing information
+ */
+
+/**
+ *  SlabPool is a per-thread, size-class allocator that sits behind
+ *  WBMMPolicy.  Small blocks come from 64KB spans, each of which holds blocks
+ *  of a single size class and belongs to a single thread.  A thread reuses
+ *  the blocks it frees (after the WBMMPolicy grace period) without touching
+ *  any shared state.  Blocks freed by some other thread are collected into
+ *  batches, which are pushed onto the owner's inbox, and the owner takes the
+ *  whole inbox when it runs out of blocks of some class.
+ *
+ *  All spans are carved from one big reservation, so telling a slab block
+ *  from a malloc block is a range check.  That lets tx_free() take memory
+ *  from either source, but memory from tx_alloc() must not be passed to
+ *  free().  Since some programs (e.g., STAMP's P_FREE) do exactly that,
+ *  slabs are off by default, and tx_alloc() is plain malloc().  Setting
+ *  STM_SLABS turns them on, and then such programs have undefined
+ *  behavior.  Spans are never returned to the OS.
+ */
+
+#ifndef SLABPOOL_HPP__
+#define SLABPOOL_HPP__
+
+#include <stdlib.h>
+#include <stm/config.h>
+#include "common/platform.hpp"
+#include "stm/metadata.hpp"
+
+namespace stm
+{
+  class SlabPool
+  {
+    public:
+      /*** 16-byte classes up to 128, then four classes per power of two */
+      static const uint32_t CLASSES  = 28;
+      static const size_t   MAX_SIZE = 4096;
+      static const size_t   SPAN     = 64 * 1024;
+      /*** cross-thread frees are handed back this many at a time */
+      static const uint32_t BATCH    = 64;
+
+      /*** a free block; next_batch is only used by the head of a batch */
+      struct block_t
+      {
+          block_t* next;
+          block_t* next_batch;
+      };
+
+      /*** the reservation that all spans come from (NULL if slabs are off) */
+      static char* base;
+      static char* limit;
+
+      /*** is this a slab block? */
+      static bool owns(const void* p)
+      {
+          return ((const char*)p >= base) && ((const char*)p < limit);
+      }
+
+      static uint32_t classOf(size_t size)
+      {
+          if (size <= 128)
+              return size ? (size - 1) / 16 : 0;
+          uint32_t b = 63 - __builtin_clzll(size - 1);
+          return 8 + (b - 7) * 4 + (((size - 1) >> (b - 2)) & 3);
+      }
+
+      /*** reserve the address space, if STM_SLABS is set (see SlabPool.cpp) */
+      static void init();
+
+      /*** a thread's pool learns its (0-based) id from WBMMPolicy::setID */
+      void setID(uint32_t id) { owner = id; }
+
+      void* alloc(size_t size)
+      {
+          if (!base || (size > MAX_SIZE))
+              return malloc(size);
+          uint32_t c = classOf(size);
+          block_t* b = free_lists[c];
+          if (__builtin_expect(b != NULL, true)) {
+              free_lists[c] = b->next;
+              return b;
+          }
+          return refill(c, size);
+      }
+
+      /*** return a block to its owner, or to malloc */
+      void release(void* p)
+      {
+          if (!owns(p)) {
+              free(p);
+              return;
+          }
+          uint32_t s = spanOf(p);
+          if (spans[s].owner == owner) {
+              block_t* b = (block_t*)p;
+              b->next = free_lists[spans[s].cls];
+              free_lists[spans[s].cls] = b;
+              return;
+          }
+          sendRemote(p, spans[s].owner);
+      }
+
+      /*** hand all partial batches of remote frees to their owners */
+      void flush();
+
+      SlabPool();
+
+    private:
+      struct span_t
+      {
+          uint16_t owner;
+          uint8_t  cls;
+          uint8_t  pad;
+      };
+
+      /*** one span_t per SPAN bytes of the reservation */
+      static span_t* spans;
+
+      static uint32_t spanOf(const void* p)
+      {
+          return ((const char*)p - base) / SPAN;
+      }
+
+      /*** a batch of blocks that belong to some other thread */
+      struct batch_t
+      {
+          block_t* head;
+          uint32_t count;
+      };
+
+      uint32_t  owner;
+      block_t*  free_lists[CLASSES];
+      char*     bump[CLASSES];       // uncarved part of each class's span
+      char*     bump_end[CLASSES];
+      batch_t*  outgoing;            // [MAX_THREADS], allocated on demand
+
+      /*** take the inbox, else carve a block, else fall back to malloc */
+      NOINLINE void* refill(uint32_t c, size_t size);
+
+      /*** add p to the batch for its owner, and send the batch if full */
+      NOINLINE void sendRemote(void* p, uint32_t to);
+  };
+
+} // namespace stm
+
+#endif // SLABPOOL_HPP__
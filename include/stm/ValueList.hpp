@@ -69,6 +69,10 @@ namespace stm {
       bool isValid() const {
           return *addr == val;
       }
+
+      void** getAddress() const {
+          return addr;
+      }
   };
 
   /**
@@ -129,6 +133,10 @@ namespace stm {
       bool isValid() const {
           return ((uintptr_t)val & mask) == ((uintptr_t)*addr & mask);
       }
+
+      void** getAddress() const {
+          return addr;
+      }
   };
 
   /**
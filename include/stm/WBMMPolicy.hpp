@@ -28,6 +28,7 @@
 #include <stm/config.h>
 #include "stm/MiniVector.hpp"
 #include "stm/metadata.hpp"
+#include "stm/SlabPool.hpp"
 
 namespace stm
 {
@@ -37,7 +38,11 @@ namespace stm
   /*** store every thread's counter */
   extern pad_word_t trans_nums[MAX_THREADS];
 
-  /*** Node type for a list of timestamped void*s */
+  /**
+   *  Node type for a list of timestamped void*s.  A limbo_t is allocated
+   *  with room for one timestamp per thread that existed when it was
+   *  sealed, rather than for MAX_THREADS of them.
+   */
   struct limbo_t
   {
       /*** Number of void*s held in a limbo_t */
@@ -46,17 +51,22 @@ namespace stm
       /*** Set of void*s */
       void*     pool[POOL_SIZE];
 
-      /*** Timestamp when last void* was added */
-      uint32_t  ts[MAX_THREADS];
+      /*** The next-newer node of the limbo list */
+      limbo_t*  newer;
 
-      /*** # valid timestamps in ts, or # elements in pool */
+      /*** # valid timestamps in ts, and room for how many */
       uint32_t  length;
+      uint32_t  capacity;
 
-      /*** NehelperMin pointer for the limbo list */
-      limbo_t*  older;
+      /*** Timestamp when last void* was added (really ts[capacity]) */
+      uint32_t  ts[1];
+  };
 
-      /*** The constructor for the limbo_t just zeroes out everything */
-      limbo_t() : length(0), older(NULL) { }
+  /*** A block allocated by a transaction, and the size it asked for */
+  struct sized_block_t
+  {
+      void*  ptr;
+      size_t size;
   };
 
   /**
@@ -73,16 +83,40 @@ namespace stm
       volatile uintptr_t* my_ts;
 
       /*** As we mark things for deletion, we accumulate them here */
-      limbo_t* prelimbo;
+      void*    prelimbo[limbo_t::POOL_SIZE];
+      uint32_t prelimbo_length;
 
-      /*** sorted list of timestamped reclaimables */
+      /*** list of timestamped reclaimables, oldest first */
       limbo_t* limbo;
+      limbo_t* newest;
+
+      /*** a few nodes that we have emptied, for reuse */
+      limbo_t* spare;
+      uint32_t spare_count;
+      static const uint32_t MAX_SPARE = 16;
 
       /*** List of objects to delete if the current transaction commits */
       AddressList frees;
 
       /*** List of objects to delete if the current transaction aborts */
-      AddressList allocs;
+      MiniVector<sized_block_t> allocs;
+
+      /**
+       *  When a transaction aborts, we keep (some of) its allocations here,
+       *  since the retry will most likely ask for the same sizes again.
+       *  Whatever is left when the transaction commits gets freed.
+       */
+      static const uint32_t STASH_SIZE = 32;
+      sized_block_t stash[STASH_SIZE];
+      uint32_t      stash_count;
+      bool          retrying;
+
+      /*** The latest block that this transaction allocated (see captured) */
+      uintptr_t capture_base;
+      size_t    capture_size;
+
+      /*** Where blocks come from, and where reclaimed blocks go */
+      SlabPool slabs;
 
       /**
        *  Schedule a pointer for reclamation.  Reclamation will not happen
@@ -91,9 +125,9 @@ namespace stm
       void schedForReclaim(void* ptr)
       {
           // insert /ptr/ into the prelimbo pool and increment the pool size
-          prelimbo->pool[prelimbo->length++] = ptr;
+          prelimbo[prelimbo_length++] = ptr;
           // if prelimbo is not full, we're done
-          if (prelimbo->length != prelimbo->POOL_SIZE)
+          if (prelimbo_length != limbo_t::POOL_SIZE)
               return;
           // if prelimbo is full, we have a lot more work to do
           handle_full_prelimbo();
@@ -107,15 +141,36 @@ namespace stm
        */
       NOINLINE void handle_full_prelimbo();
 
+      /*** find a stashed block of exactly /size/ bytes, or return NULL */
+      NOINLINE void* unstash(size_t size);
+
+      /*** free the blocks that a retry didn't reuse */
+      NOINLINE void clear_stash();
+
     public:
 
+      /**
+       *  With STM_RECLAIMER set, a background thread frees the nodes that
+       *  handle_full_prelimbo finds to be safe, so that committers don't.  If
+       *  it falls too far behind, committers go back to freeing inline.
+       */
+      static void startReclaimer();
+      static void stopReclaimer();
+
+      /*** allocations in retries that did and didn't reuse a stashed block */
+      uint64_t stash_hits;
+      uint64_t stash_misses;
+
       /**
        *  Constructing the DeferredReclamationMMPolicy is very easy
        *  Null out the timestamp for a particular thread.  We only call this
        *  at initialization.
        */
       WBMMPolicy()
-          : prelimbo(new limbo_t()), limbo(NULL), frees(128), allocs(128)
+          : prelimbo_length(0), limbo(NULL), newest(NULL), spare(NULL),
+            spare_count(0), frees(128), allocs(128), stash_count(0),
+            retrying(false), capture_base(0), capture_size(0),
+            stash_hits(0), stash_misses(0)
       { }
 
       /**
@@ -123,35 +178,69 @@ namespace stm
        *  need the TxThread to inform the allocator of its id from within the
        *  constructor, via this method.
        */
-      void setID(uint32_t id) { my_ts = &trans_nums[id].val; }
+      void setID(uint32_t id)
+      {
+          my_ts = &trans_nums[id].val;
+          slabs.setID(id);
+      }
 
       /*** Wrapper to thread-specific allocator for allocating memory */
       void* txAlloc(size_t const &size)
       {
-          void* ptr = malloc(size);
-          if ((*my_ts)&1)
-              allocs.insert(ptr);
+          if (!((*my_ts)&1))
+              return slabs.alloc(size);
+          void* ptr = retrying ? unstash(size) : NULL;
+          if (!ptr)
+              ptr = slabs.alloc(size);
+          sized_block_t b = {ptr, size};
+          allocs.insert(b);
+          capture_base = (uintptr_t)ptr;
+          capture_size = size;
           return ptr;
       }
 
+      /**
+       *  Is [addr, addr + len) inside a block that the current transaction
+       *  allocated?  Such memory is invisible to other threads until the
+       *  transaction publishes it, and is discarded if the transaction
+       *  aborts, so the barriers can access it directly.
+       *
+       *  We only remember the latest allocation, which is what a transaction
+       *  usually initializes, so that this check is cheap enough for every
+       *  barrier.  Once a block stops being the latest, we never consider it
+       *  captured again, so an address that went through a read barrier is
+       *  never written behind the barrier's back.
+       */
+      bool captured(const void* addr, size_t len) const
+      {
+          uintptr_t off = (uintptr_t)addr - capture_base;
+          return (off < capture_size) && (len <= capture_size - off);
+      }
+
       /*** Wrapper to thread-specific allocator for freeing memory */
       void txFree(void* ptr)
       {
           if ((*my_ts)&1)
               frees.insert(ptr);
           else
-              free(ptr);
+              slabs.release(ptr);
       }
 
       /*** On begin, move to an odd epoch and start logging */
       void onTxBegin() { *my_ts = 1 + *my_ts; }
 
-      /*** On abort, unroll allocs, clear lists, exit epoch */
+      /*** On abort, stash or unroll allocs, clear lists, exit epoch */
       void onTxAbort()
       {
-          AddressList::iterator i, e;
-          for (i = allocs.begin(), e = allocs.end(); i != e; ++i)
-              free(*i);
+          MiniVector<sized_block_t>::iterator i, e;
+          for (i = allocs.begin(), e = allocs.end(); i != e; ++i) {
+              if (stash_count < STASH_SIZE)
+                  stash[stash_count++] = *i;
+              else
+                  slabs.release(i->ptr);
+          }
+          retrying = true;
+          capture_size = 0;
           frees.reset();
           allocs.reset();
           *my_ts = 1+*my_ts;
@@ -165,6 +254,9 @@ namespace stm
               schedForReclaim(*i);
           frees.reset();
           allocs.reset();
+          capture_size = 0;
+          if (retrying)
+              clear_stash();
           *my_ts = 1+*my_ts;
       }
   }; // class stm::WBMMPolicy
@@ -39,6 +39,21 @@
 // Histogram generation
 #cmakedefine STM_COUNTCONSEC_YES
 
+// Abort-cause attribution
+#cmakedefine STM_CONFLICTS_YES
+
+// Transaction event tracing
+#cmakedefine STM_TRACE_YES
+
+// Latency histograms
+#cmakedefine STM_LATENCY_YES
+
+// Barrier-free access to transaction-local allocations
+#cmakedefine STM_CAPTURE_YES
+
+// Hardware counters
+#cmakedefine STM_PERFCTR_YES
+
 // ProfileTMtrigger
 #cmakedefine STM_PROFILETMTRIGGER_ALL
 #cmakedefine STM_PROFILETMTRIGGER_PATHOLOGY
@@ -0,0 +1,175 @@
+/**
+ *  Copyright (C) 2011
+ *  University of Rochester Department of Computer Science
+ *    and
+ *  Lehigh University Department of Computer Science and Engineering
+ *
+ * License: Modified BSD
+ *          Please see the file LICENSE.RSTM for licensing information
+ */
+
+/**
+ *  Commutative updates (TM_ADD, TM_MAX, and TM_MIN; see library.hpp).  A
+ *  transaction that only adds to a counter doesn't need to know its value,
+ *  but reading and writing it through the barriers makes every pair of such
+ *  transactions conflict.  Instead, we log the update in the thread's
+ *  DeferredList, which is part of its redo log, and never read the location
+ *  through the barriers.
+ *
+ *  Algorithms whose commit can do the updates provide alg_t::defer.  They
+ *  lock the updated locations along with the written ones (NOrec's
+ *  sequence lock covers everything; OrecLazy acquires each update's orec,
+ *  whatever its version), and do the updates right after the write-back,
+ *  before they let go.  Since the locations are not in the read set, two
+ *  transactions that only update them never fail each other's validation.
+ *  A transaction that read the location does, as with any write.
+ *
+ *  For every other algorithm (eager and undo-log ones, say), and whenever
+ *  the thread's barriers aren't its algorithm's own, commit() replays the
+ *  log through the read and write barriers instead, so the updates are
+ *  ordinary writes that conflict at the end of the transaction.
+ *
+ *  Either way, a transaction doesn't see its own updates, and they take
+ *  effect after its other writes.  An aborted attempt's log is dropped by
+ *  the next begin().
+ */
+
+#ifndef DEFERRED_HPP__
+#define DEFERRED_HPP__
+
+#include <stm/config.h>
+#include <common/platform.hpp>
+#include <stm/MiniVector.hpp>
+
+namespace stm
+{
+  class TxThread;
+
+  /**
+   *  One logged update.  update(addr, val) does it while the commit holds
+   *  the location's lock, and replay(addr, val, tx) does it through the
+   *  barriers.
+   */
+  struct deferred_op_t
+  {
+      void*    addr;
+      void     (*update)(void* addr, uint64_t val);
+      void     (*replay)(void* addr, uint64_t val, TxThread* tx);
+      uint64_t val;     // the operand's bits
+  };
+
+  typedef MiniVector<deferred_op_t> DeferredList;
+
+  /*** the operations */
+  struct deferred_add
+  {
+      template <typename T> static T op(T a, T b) { return a + b; }
+  };
+
+  struct deferred_max
+  {
+      template <typename T> static T op(T a, T b) { return (a < b) ? b : a; }
+  };
+
+  struct deferred_min
+  {
+      template <typename T> static T op(T a, T b) { return (b < a) ? b : a; }
+  };
+
+  /*** the unsigned integer type with the same size as a T */
+  template <size_t S> struct deferred_word { };
+  template <> struct deferred_word<1> { typedef uint8_t  type; };
+  template <> struct deferred_word<2> { typedef uint16_t type; };
+  template <> struct deferred_word<4> { typedef uint32_t type; };
+  template <> struct deferred_word<8> { typedef uint64_t type; };
+
+  /**
+   *  Under the location's lock, an update is a plain read and write.
+   *  Outside of a transaction, it is a CAS loop on the bits of the T, and we
+   *  don't bother with the CAS when a max or min changes nothing.
+   */
+  template <typename T, class OP>
+  struct deferred
+  {
+      typedef typename deferred_word<sizeof(T)>::type word_t;
+      union bits_t { T t; word_t w; };
+
+      static uint64_t pack(T val)
+      {
+          bits_t b;
+          b.t = val;
+          return b.w;
+      }
+
+      static T unpack(uint64_t val)
+      {
+          bits_t b;
+          b.w = (word_t)val;
+          return b.t;
+      }
+
+      static void update(void* addr, uint64_t val)
+      {
+          bits_t operand, old;
+          operand.w = (word_t)val;
+          old.w = *(word_t*)addr;
+          old.t = OP::op(old.t, operand.t);
+          *(word_t*)addr = old.w;
+      }
+
+      static void apply(void* addr, uint64_t val)
+      {
+          volatile word_t* a = (volatile word_t*)addr;
+          bits_t operand, old, upd;
+          operand.w = (word_t)val;
+          do {
+              old.w = *a;
+              upd.t = OP::op(old.t, operand.t);
+              if (upd.w == old.w)
+                  return;
+          } while (!__sync_bool_compare_and_swap(a, old.w, upd.w));
+      }
+  };
+
+  /*** integer adds are a fetch-and-add */
+#define STM_DEFERRED_FETCH_ADD(T)                                       \
+  template <>                                                           \
+  struct deferred<T, deferred_add>                                      \
+  {                                                                     \
+      static uint64_t pack(T val) { return (uint64_t)val; }             \
+      static T unpack(uint64_t val) { return (T)val; }                  \
+      static void update(void* addr, uint64_t val)                      \
+      {                                                                 \
+          *(T*)addr += (T)val;                                          \
+      }                                                                 \
+      static void apply(void* addr, uint64_t val)                       \
+      {                                                                 \
+          __sync_fetch_and_add((volatile T*)addr, (T)val);              \
+      }                                                                 \
+  };
+
+  STM_DEFERRED_FETCH_ADD(int)
+  STM_DEFERRED_FETCH_ADD(unsigned int)
+  STM_DEFERRED_FETCH_ADD(long)
+  STM_DEFERRED_FETCH_ADD(unsigned long)
+  STM_DEFERRED_FETCH_ADD(long long)
+  STM_DEFERRED_FETCH_ADD(unsigned long long)
+
+#undef STM_DEFERRED_FETCH_ADD
+
+  /**
+   *  Commit and abort handlers (stm::on_commit and stm::on_abort; see
+   *  library.hpp).  These let a transaction defer a side effect, like I/O,
+   *  until it knows whether it committed, instead of becoming irrevocable.
+   */
+  struct handler_t
+  {
+      void (*fn)(void* arg);
+      void* arg;
+  };
+
+  typedef MiniVector<handler_t> HandlerList;
+
+} // namespace stm
+
+#endif // DEFERRED_HPP__
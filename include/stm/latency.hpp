@@ -0,0 +1,147 @@
+/**
+ *  Copyright (C) 2011
+ *  University of Rochester Department of Computer Science
+ *    and
+ *  Lehigh University Department of Computer Science and Engineering
+ *
+ * License: Modified BSD
+ *          Please see the file LICENSE.RSTM for licensing information
+ */
+
+/**
+ *  Per-thread latency histograms.  When libstm is built with
+ *  libstm_enable_latency_histograms, every commit records how long the
+ *  transaction took since its first begin, how long the commit itself took,
+ *  and how many times it aborted first.  sys_shutdown merges the threads'
+ *  histograms and prints percentiles (see latency.cpp).
+ *
+ *  The histograms are log-linear: values below 4 have their own bucket, and
+ *  every power of two above that is split into 4 buckets, so a bucket is
+ *  never more than 25% wide and recording is a clz and an increment.
+ */
+
+#ifndef LATENCY_HPP__
+#define LATENCY_HPP__
+
+#include <stm/config.h>
+#include <common/platform.hpp>
+
+namespace stm
+{
+  struct log_histogram_t
+  {
+      /*** 4 linear buckets for each of the 62 powers of two above 3 */
+      static const uint32_t SUB     = 4;
+      static const uint32_t BUCKETS = 63 * SUB;
+
+      uint64_t count;
+      uint64_t max;
+      uint64_t buckets[BUCKETS];
+
+      static uint32_t msb(uint64_t v)
+      {
+#if defined(STM_CC_GCC) || defined(STM_CC_LLVM)
+          return 63 - __builtin_clzll(v);
+#else
+          uint32_t b = 0;
+          while (v >>= 1)
+              ++b;
+          return b;
+#endif
+      }
+
+      static uint32_t index(uint64_t v)
+      {
+          if (v < SUB)
+              return v;
+          uint32_t b = msb(v);
+          return (b - 1) * SUB + ((v >> (b - 2)) & (SUB - 1));
+      }
+
+      /*** the smallest value that lands in bucket i */
+      static uint64_t lower(uint32_t i)
+      {
+          if (i < SUB)
+              return i;
+          return (uint64_t)(SUB + i % SUB) << (i / SUB - 1);
+      }
+
+      void add(uint64_t v)
+      {
+          ++buckets[index(v)];
+          ++count;
+          if (v > max)
+              max = v;
+      }
+
+      void merge(const log_histogram_t& h)
+      {
+          for (uint32_t i = 0; i < BUCKETS; ++i)
+              buckets[i] += h.buckets[i];
+          count += h.count;
+          if (h.max > max)
+              max = h.max;
+      }
+
+      /*** the upper bound of the bucket that holds the p'th percentile */
+      uint64_t percentile(double p) const;
+
+      /*** print percentiles and the non-empty buckets (see latency.cpp) */
+      void dump(const char* name, const char* unit) const;
+
+      log_histogram_t() : count(0), max(0)
+      {
+          for (uint32_t i = 0; i < BUCKETS; ++i)
+              buckets[i] = 0;
+      }
+  };
+
+  /**
+   *  The three histograms of a thread.  The commit path calls
+   *  onCommitStart() before the algorithm's commit, and onCommitEnd() after
+   *  it, with the begin and end times that it already reads.
+   */
+  struct latency_histograms_t
+  {
+      log_histogram_t txn;      // first begin to commit, in cycles
+      log_histogram_t commit;   // the commit itself, in cycles
+      log_histogram_t retries;  // aborts before the commit
+
+      uint64_t commit_start;
+      uint32_t commit_retries;  // the commit resets consec_aborts
+
+      void onCommitStart(uint32_t consec_aborts)
+      {
+          commit_retries = consec_aborts;
+          commit_start = tick();
+      }
+
+      /*** not called if the commit aborts */
+      void onCommitEnd(uint64_t txn_start, uint64_t end)
+      {
+          retries.add(commit_retries);
+          commit.add(end - commit_start);
+          txn.add(end - txn_start);
+      }
+
+      latency_histograms_t() : commit_start(0), commit_retries(0) { }
+  };
+
+  /**
+   *  When STM_LATENCY_YES is not set, we don't record anything
+   */
+  struct latency_nop_t
+  {
+      void onCommitStart(uint32_t)          { }
+      void onCommitEnd(uint64_t, uint64_t)  { }
+  };
+
+#ifdef STM_LATENCY_YES
+  typedef latency_histograms_t latency_t;
+#else
+  typedef latency_nop_t latency_t;
+#endif
+
+} // namespace stm
+
+#endif // LATENCY_HPP__
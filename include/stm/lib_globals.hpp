@@ -31,6 +31,27 @@ namespace stm
   void restart();
   const char* get_algname();
 
+  /*** in-process CBR training (see the -T flag of the bench harness) */
+  void train_profile_begin();
+  void train_profile_end();
+  bool train_write_row(const char* file, const char* bm, const char* alg,
+                       uint32_t threads);
+
+  /*** the abort hotspot report (see conflicts.cpp); callable at any time */
+  void conflicts_init();
+  void dump_hotspots(uint32_t top);
+  void dump_conflict_stats();
+
+  /*** print the merged latency histograms (see latency.cpp) */
+  void dump_latency_stats();
+
+  /*** print the hardware counter totals (see perfctr.cpp) */
+  void dump_perf_stats();
+
+  /*** live statistics in shared memory (see shmstats.cpp) */
+  void shmstats_init();
+  void shmstats_shutdown();
+
   extern pad_word_t  threadcount;           // threads in system
   extern TxThread*   threads[MAX_THREADS];  // all TxThreads
 }
@@ -247,6 +247,102 @@ namespace stm
   typedef toxic_nop_t toxic_t;
 #endif
 
+  /**
+   *  The reasons a transaction can abort.  An algorithm notes the reason
+   *  (and the orec, lock, or address involved) just before it aborts, so
+   *  that we can report which locations cause the most aborts.
+   */
+  enum conflict_kind_t {
+      CONFLICT_UNKNOWN,    // the algorithm didn't say
+      CONFLICT_VALIDATION, // a location we read has changed
+      CONFLICT_LOCKED,     // a location we need is locked by another tx
+      CONFLICT_KILLED,     // another tx aborted us remotely
+      CONFLICT_RING,       // the ring rolled over before we validated
+      CONFLICT_EXPLICIT,   // stm::restart()
+      CONFLICT_KINDS
+  };
+
+  static const char* const CONFLICT_NAMES[CONFLICT_KINDS] = {
+      "unknown", "validation", "locked", "killed", "ring", "explicit"
+  };
+
+  /**
+   *  A per-thread log of the most recent aborts.  It is lossy: once full, new
+   *  aborts overwrite the oldest ones, so that recording is just a few stores
+   *  on the abort path.  The per-kind counts are exact.  See conflicts.cpp
+   *  for the hotspot report.
+   */
+  struct conflict_log_t
+  {
+      static const uint32_t SIZE = 64;
+
+      struct entry_t
+      {
+          uint32_t    kind;
+          const void* where;   // orec, bytelock, or address in conflict
+          const void* addr;    // address we were accessing, if known
+          const void* site;    // atomic block that aborted (see site_t)
+      };
+
+      /*** the cause of the abort in progress */
+      uint32_t    kind;
+      const void* where;
+      const void* addr;
+
+      /*** aborts recorded; entries[next % SIZE] is the next to overwrite */
+      uint32_t    next;
+      uint64_t    counts[CONFLICT_KINDS];
+      entry_t     entries[SIZE];
+
+      /*** remember why we are about to abort */
+      void note(conflict_kind_t k, const void* w, const void* a)
+      {
+          kind = k;
+          where = w;
+          addr = a;
+      }
+
+      /*** the noted cause of the abort in progress */
+      uint32_t pending() const { return kind; }
+
+      /*** on rollback, log the noted cause and forget it */
+      void onAbort(const void* site)
+      {
+          entry_t& e = entries[next++ % SIZE];
+          e.kind = kind;
+          e.where = where;
+          e.addr = addr;
+          e.site = site;
+          ++counts[kind];
+          kind = CONFLICT_UNKNOWN;
+          where = addr = NULL;
+      }
+
+      /*** simple constructor */
+      conflict_log_t() : kind(CONFLICT_UNKNOWN), where(NULL), addr(NULL),
+                         next(0)
+      {
+          for (int i = 0; i < CONFLICT_KINDS; ++i)
+              counts[i] = 0;
+      }
+  };
+
+  /**
+   *  When STM_CONFLICTS_YES is not set, we don't record anything
+   */
+  struct conflict_nop_t
+  {
+      void note(conflict_kind_t, const void*, const void*) { }
+      uint32_t pending() const { return CONFLICT_UNKNOWN; }
+      void onAbort(const void*) { }
+  };
+
+#ifdef STM_CONFLICTS_YES
+  typedef conflict_log_t conflicts_t;
+#else
+  typedef conflict_nop_t conflicts_t;
+#endif
+
 } // namespace stm
 
 #endif // METADATA_HPP__
@@ -0,0 +1,95 @@
+/**
+ *  Copyright (C) 2011
+ *  University of Rochester Department of Computer Science
+ *    and
+ *  Lehigh University Department of Computer Science and Engineering
+ *
+ * License: Modified BSD
+ *          Please see the file LICENSE.RSTM for licensing information
+ */
+
+/**
+ *  Per-transaction hardware counters.  When libstm is built with
+ *  libstm_enable_perf_counters, every thread opens a perf_event group of
+ *  cycle, instruction and last-level-cache miss counters, reads it when a
+ *  transaction attempt begins and again when it commits or aborts, and
+ *  charges the difference to the algorithm that ran the attempt and to its
+ *  outcome.  sys_shutdown prints the totals (see perfctr.cpp).
+ *
+ *  Reading the group is a system call, so this mode is for finding out why
+ *  an algorithm is slow, not for production runs.  If perf_event_open
+ *  fails (e.g., in a container, or with a high perf_event_paranoid), the
+ *  thread just doesn't count, and the report says why.
+ */
+
+#ifndef PERFCTR_HPP__
+#define PERFCTR_HPP__
+
+#include <stm/config.h>
+#include <common/platform.hpp>
+
+namespace stm
+{
+  class TxThread;
+
+  enum perf_outcome_t { PERF_COMMIT, PERF_ABORT, PERF_OUTCOMES };
+
+  enum perf_counter_t {
+      PERF_CYCLES, PERF_INSTRUCTIONS, PERF_LLC_MISSES, PERF_COUNTERS
+  };
+
+  /*** what one algorithm's commits (or aborts) cost */
+  struct perf_totals_t
+  {
+      uint64_t attempts;
+      uint64_t counts[PERF_COUNTERS];
+  };
+
+  struct perf_counters_t
+  {
+      int            fd;                    // group leader, or -1
+      int32_t        slot[PERF_COUNTERS];   // index in a group read, or -1
+      uint32_t       alg;                   // algorithm of this attempt
+      uint64_t       start[PERF_COUNTERS];
+      perf_totals_t* totals;                // [ALG_MAX][PERF_OUTCOMES]
+
+      /*** open this thread's counters (see perfctr.cpp) */
+      void attach();
+
+      /*** read the counters out of line */
+      void begin(const TxThread* tx);
+      void end(perf_outcome_t outcome);
+
+      void onBegin(const TxThread* tx) { if (totals) begin(tx); }
+      void onCommit()                  { if (totals) end(PERF_COMMIT); }
+      void onAbort()                   { if (totals) end(PERF_ABORT); }
+
+      perf_counters_t() : fd(-1), alg(0), totals(NULL)
+      {
+          for (int i = 0; i < PERF_COUNTERS; ++i) {
+              slot[i] = -1;
+              start[i] = 0;
+          }
+      }
+  };
+
+  /**
+   *  When STM_PERFCTR_YES is not set, we don't count anything
+   */
+  struct perf_nop_t
+  {
+      void attach()                   { }
+      void onBegin(const TxThread*)   { }
+      void onCommit()                 { }
+      void onAbort()                  { }
+  };
+
+#ifdef STM_PERFCTR_YES
+  typedef perf_counters_t perfctr_t;
+#else
+  typedef perf_nop_t perfctr_t;
+#endif
+
+} // namespace stm
+
+#endif // PERFCTR_HPP__
@@ -0,0 +1,68 @@
+/**
+ *  Copyright (C) 2011
+ *  University of Rochester Department of Computer Science
+ *    and
+ *  Lehigh University Department of Computer Science and Engineering
+ *
+ * License: Modified BSD
+ *          Please see the file LICENSE.RSTM for licensing information
+ */
+
+/**
+ *  The layout of the shared memory segment in which libstm publishes live
+ *  statistics (see libstm/shmstats.cpp), so that a separate process (e.g.,
+ *  tools/stmstat) can monitor a running program.
+ *
+ *  The library rewrites the segment periodically, using the 'seq' field as
+ *  a sequence lock: it is odd while an update is in progress.  A reader
+ *  copies the segment, and retries if 'seq' was odd or changed during the
+ *  copy.  Neither side ever waits for the other.
+ */
+
+#ifndef SHMSTATS_HPP__
+#define SHMSTATS_HPP__
+
+#include <stm/config.h>
+#include <stm/metadata.hpp>
+
+namespace stm
+{
+  static const char     SHM_STATS_MAGIC[8] = {'R','S','T','M','S','T','A','T'};
+  static const uint32_t SHM_STATS_VERSION  = 1;
+  static const uint32_t SHM_STATS_NAMELEN  = 32;
+
+  /*** the counters for one thread, or for all of them */
+  struct shm_thread_stats_t
+  {
+      uint64_t commits;                 // read-write commits
+      uint64_t ro_commits;              // read-only commits
+      uint64_t aborts;
+      uint64_t restarts;                // calls to stm::restart()
+      uint64_t txn_cycles;              // first begin to commit, summed
+      uint64_t nontxn_cycles;           // time between transactions
+      uint64_t causes[CONFLICT_KINDS];  // aborts, by conflict_kind_t
+  };
+
+  struct shm_stats_t
+  {
+      char     magic[8];
+      uint32_t version;
+      uint32_t size;                    // sizeof(shm_stats_t)
+      volatile uint64_t seq;            // odd while being written
+
+      uint64_t pid;
+      uint64_t updates;                 // how many times we've published
+      uint64_t timestamp;               // tick() of the last update
+      uint64_t switches;                // algorithm switches so far
+      uint32_t threads;                 // entries of thread[] in use
+      uint32_t causes_valid;            // is abort attribution compiled in?
+      char     algorithm[SHM_STATS_NAMELEN];
+      char     policy[SHM_STATS_NAMELEN];
+
+      shm_thread_stats_t total;
+      shm_thread_stats_t thread[MAX_THREADS];
+  };
+
+} // namespace stm
+
+#endif // SHMSTATS_HPP__
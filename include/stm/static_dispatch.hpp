@@ -0,0 +1,147 @@
+/**
+ *  Copyright (C) 2011
+ *  University of Rochester Department of Computer Science
+ *    and
+ *  Lehigh University Department of Computer Science and Engineering
+ *
+ * License: Modified BSD
+ *          Please see the file LICENSE.RSTM for licensing information
+ */
+
+/**
+ *  Barriers for the static-dispatch variants of libstm (see
+ *  libstm_static_dispatch in libstm/UserConfig.cmake).  A program and a
+ *  library that are both built with STM_STATIC_DISPATCH_<alg> always run
+ *  <alg>, so DISPATCH can call these copies of its word barriers directly,
+ *  instead of through tx->tmread and tx->tmwrite, and the compiler can
+ *  inline them into the program.  Begin, commit, and abort still go through
+ *  the usual pointers, since they happen once per transaction.
+ *
+ *  This only works for algorithms whose barriers are small enough to live in
+ *  a header, and that can tell from the transaction's state which of their
+ *  barriers it would be using.  The copies must match libstm/algs/<alg>.cpp.
+ */
+
+#ifndef STATIC_DISPATCH_HPP__
+#define STATIC_DISPATCH_HPP__
+
+#include <stm/config.h>
+#include <common/platform.hpp>
+#include <stm/txthread.hpp>
+#include <stm/UndoLog.hpp> // STM_DO_MASKED_WRITE
+
+#if defined(STM_STATIC_DISPATCH_CGL)
+#  define STM_STATIC_DISPATCH "CGL"
+#elif defined(STM_STATIC_DISPATCH_TML)
+#  define STM_STATIC_DISPATCH "TML"
+#elif defined(STM_STATIC_DISPATCH_NOrec)
+#  define STM_STATIC_DISPATCH "NOrec"
+#endif
+
+namespace stm
+{
+  /*** the global sequence lock (see algs.hpp) */
+  extern pad_word_t timestamp;
+
+  /**
+   *  TM_BEGIN_FAST_INITIALIZATION can't switch the program to CGL's barriers,
+   *  so it makes the (only) thread's barriers plain accesses instead.
+   */
+  inline void static_fast_initialization(TxThread* tx, bool on)
+  {
+#if defined(STM_STATIC_DISPATCH_TML)
+      tx->tmlHasLock = on;
+#elif defined(STM_STATIC_DISPATCH_NOrec)
+      tx->irrevocable = on;
+#endif
+  }
+
+#if defined(STM_STATIC_DISPATCH_CGL)
+  /**
+   *  CGL: the transaction holds the lock, so its accesses are plain
+   */
+  TM_INLINE
+  inline void* static_read(STM_READ_SIG(,addr,))
+  {
+      return *addr;
+  }
+
+  TM_INLINE
+  inline void static_write(STM_WRITE_SIG(,addr,val,mask))
+  {
+      STM_DO_MASKED_WRITE(addr, val, mask);
+  }
+
+#elif defined(STM_STATIC_DISPATCH_TML)
+  /**
+   *  TML: a reader checks the sequence lock after every read, and the first
+   *  write takes the lock (see tml_inline.hpp)
+   */
+  TM_INLINE
+  inline void* static_read(STM_READ_SIG(tx,addr,))
+  {
+      void* val = *addr;
+      if (tx->tmlHasLock)
+          return val;
+      CFENCE;
+      if (__builtin_expect(timestamp.val != tx->start_time, false))
+          TxThread::tmabort(tx);
+      return val;
+  }
+
+  TM_INLINE
+  inline void static_write(STM_WRITE_SIG(tx,addr,val,mask))
+  {
+      if (!tx->tmlHasLock) {
+          if (!bcasptr(&timestamp.val, tx->start_time, tx->start_time + 1))
+              TxThread::tmabort(tx);
+          ++tx->start_time;
+          tx->tmlHasLock = true;
+      }
+      STM_DO_MASKED_WRITE(addr, val, mask);
+  }
+
+#elif defined(STM_STATIC_DISPATCH_NOrec)
+  /**
+   *  NOrec: reads are logged by value, and validated whenever the sequence
+   *  lock has moved, and writes are buffered.  Since we can't switch
+   *  barriers on the first write, a read checks the write set's size
+   *  instead, and the library's read-only commit hands a transaction with
+   *  writes to the writer's commit.  An irrevocable transaction runs alone,
+   *  so its accesses are plain.  The slow paths are in libstm/algs/norec.cpp.
+   */
+  void norec_revalidate(TxThread* tx);
+  void* norec_read_rw(STM_READ_SIG(tx,addr,mask));
+
+  TM_INLINE
+  inline void* static_read(STM_READ_SIG(tx,addr,mask))
+  {
+      if (__builtin_expect(tx->irrevocable, false))
+          return *addr;
+      if (tx->writes.size())
+          return norec_read_rw(tx, addr STM_MASK(mask));
+      void* val = *addr;
+      CFENCE;
+      while (__builtin_expect(tx->start_time != timestamp.val, false)) {
+          norec_revalidate(tx);
+          val = *addr;
+          CFENCE;
+      }
+      STM_LOG_VALUE(tx, addr, val, mask);
+      return val;
+  }
+
+  TM_INLINE
+  inline void static_write(STM_WRITE_SIG(tx,addr,val,mask))
+  {
+      if (__builtin_expect(tx->irrevocable, false)) {
+          STM_DO_MASKED_WRITE(addr, val, mask);
+          return;
+      }
+      tx->writes.insert(WriteSetEntry(STM_WRITE_SET_ENTRY(addr, val, mask)));
+  }
+#endif
+
+} // namespace stm
+
+#endif // STATIC_DISPATCH_HPP__
@@ -0,0 +1,151 @@
+/**
+ *  Copyright (C) 2011
+ *  University of Rochester Department of Computer Science
+ *    and
+ *  Lehigh University Department of Computer Science and Engineering
+ *
+ * License: Modified BSD
+ *          Please see the file LICENSE.RSTM for licensing information
+ */
+
+/**
+ *  The transaction event tracer.  When libstm is built with
+ *  libstm_enable_tracing and run with STM_TRACE=<file>, every thread logs
+ *  its begins, commits, aborts, algorithm switches, and irrevocability into
+ *  a private buffer, which it appends to the file whenever it fills.  The
+ *  file is a trace_header_t, then the algorithm names, then events in no
+ *  particular order (see tools/stmtrace.cpp).
+ *
+ *  Without libstm_enable_tracing, the per-thread tracer is a trace_nop_t,
+ *  and costs nothing.
+ */
+
+#ifndef TRACE_HPP__
+#define TRACE_HPP__
+
+#include <stm/config.h>
+#include <common/platform.hpp>
+#include <stm/metadata.hpp>
+
+namespace stm
+{
+  enum trace_type_t {
+      TRACE_BEGIN,   // first attempt of a transaction
+      TRACE_COMMIT,
+      TRACE_ABORT,   // arg is the conflict_kind_t
+      TRACE_SWITCH,  // arg is the new algorithm
+      TRACE_IRREVOC, // the transaction became irrevocable
+      TRACE_TYPES
+  };
+
+  static const char* const TRACE_NAMES[TRACE_TYPES] = {
+      "begin", "commit", "abort", "switch", "irrevoc"
+  };
+
+  struct trace_event_t
+  {
+      uint64_t time;     // tick()
+      uint16_t thread;   // TxThread id
+      uint8_t  type;     // trace_type_t
+      uint8_t  pad;
+      uint32_t arg;
+      uint32_t reads;    // read log entries (commit and abort)
+      uint32_t writes;   // write/undo log entries (commit and abort)
+  };
+
+  static const char     TRACE_MAGIC[8]   = {'R','S','T','M','T','R','C','E'};
+  static const uint32_t TRACE_VERSION    = 1;
+  static const uint32_t TRACE_NAMELEN    = 32;
+
+  struct trace_header_t
+  {
+      char     magic[8];
+      uint32_t version;
+      uint32_t event_size;   // sizeof(trace_event_t)
+      uint32_t alg_count;    // followed by alg_count TRACE_NAMELEN names
+      uint32_t name_len;
+      uint32_t initial_alg;  // the algorithm before any switch event
+      uint32_t pad;
+  };
+
+  /**
+   *  A thread's trace buffer.  'events' is NULL unless tracing is on.
+   */
+  struct trace_buffer_t
+  {
+      static const uint32_t SIZE = 4096;
+
+      trace_event_t* events;
+      uint32_t       next;
+      uint16_t       thread;
+
+      /*** allocate the buffer, if STM_TRACE is set (see trace.cpp) */
+      void attach(uint32_t id);
+
+      /*** append the buffer to the trace file */
+      void flush();
+
+      bool enabled() const { return events != NULL; }
+
+      void record(uint64_t time, uint32_t type, uint32_t arg,
+                  uint32_t reads = 0, uint32_t writes = 0)
+      {
+          if (!events)
+              return;
+          trace_event_t& e = events[next];
+          e.time = time;
+          e.thread = thread;
+          e.type = type;
+          e.pad = 0;
+          e.arg = arg;
+          e.reads = reads;
+          e.writes = writes;
+          if (++next == SIZE)
+              flush();
+      }
+
+      trace_buffer_t() : events(NULL), next(0), thread(0) { }
+  };
+
+  /**
+   *  When STM_TRACE_YES is not set, we don't record anything
+   */
+  struct trace_nop_t
+  {
+      void attach(uint32_t) { }
+      void flush() { }
+      bool enabled() const { return false; }
+      void record(uint64_t, uint32_t, uint32_t, uint32_t = 0, uint32_t = 0) { }
+  };
+
+#ifdef STM_TRACE_YES
+  typedef trace_buffer_t trace_t;
+#else
+  typedef trace_nop_t trace_t;
+#endif
+
+  /**
+   *  The sizes of a transaction's logs, for commit and abort events.  Each
+   *  algorithm only uses some of these lists, and the rest are empty.  This
+   *  is a template so that we needn't include txthread.hpp.
+   */
+  template <class TX>
+  inline uint32_t trace_reads(const TX* tx)
+  {
+      return tx->r_orecs.size() + tx->vlist.size() + tx->r_bytelocks.size()
+           + tx->r_bitlocks.size() + tx->nanorecs.size();
+  }
+
+  template <class TX>
+  inline uint32_t trace_writes(const TX* tx)
+  {
+      return tx->writes.size() + tx->undo_log.size();
+  }
+
+  /*** start and finish the trace file (see trace.cpp) */
+  void trace_init();
+  void trace_shutdown();
+
+} // namespace stm
+
+#endif // TRACE_HPP__
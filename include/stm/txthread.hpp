@@ -24,10 +24,26 @@
 #include "stm/WriteSet.hpp"
 #include "stm/UndoLog.hpp"
 #include "stm/ValueList.hpp"
+#include "stm/deferred.hpp"
+#include "stm/trace.hpp"
+#include "stm/latency.hpp"
+#include "stm/perfctr.hpp"
 #include "WBMMPolicy.hpp"
 
 namespace stm
 {
+  struct txio_t;
+
+  /**
+   *  Every lexical atomic block gets a site_t (see TM_BEGIN), so that the
+   *  runtime can profile and pick an algorithm per block.  It must be
+   *  zero-initialized; the library assigns the id on first use.
+   */
+  struct site_t
+  {
+      volatile uint32_t id;
+  };
+
   /**
    *  The TxThread struct holds all of the metadata that a thread needs in
    *  order to use any of the STM algorithms we support.  In the past, this
@@ -84,8 +100,16 @@ namespace stm
       uintptr_t      cm_ts;         // the contention manager timestamp
       filter_t*      cf;            // conflict filter (RingALA)
       NanorecList    nanorecs;      // list of nanorecs held
+      DeferredList   deferred;      // commutative updates, for commit
+      HandlerList    commit_handlers; // on_commit() calls, for commit
+      HandlerList    abort_handlers;  // on_abort() calls, for rollback
+      txio_t*        io;            // buffered output, if any (txio.cpp)
       uint32_t       consec_commits;// count consec commits
       toxic_t        abort_hist;    // for counting poison
+      conflicts_t    conflicts;     // why recent aborts happened
+      trace_t        trace;         // event buffer, if tracing
+      latency_t      latency;       // commit latency histograms
+      perfctr_t      perf;          // hardware counters, if counting
       uint32_t       begin_wait;    // how long did last tx block at begin
       bool           strong_HG;     // for strong hourglass
       bool           irrevocable;   // tells begin_blocker that I'm THE ONE
@@ -93,6 +117,15 @@ namespace stm
       /*** PER-THREAD FIELDS FOR ENABLING ADAPTIVITY POLICIES */
       uint64_t      end_txn_time;      // end of non-transactional work
       uint64_t      total_nontxn_time; // time on non-transactional work
+      uint64_t      txn_start;         // first begin of the current txn
+      uint64_t      total_txn_time;    // first begin to commit, all txns
+      uintptr_t     alg_epoch;         // switch_epoch of my installed alg
+      site_t*       site;              // atomic block of the current txn
+      int32_t       site_arm;          // its per-site choice, or -1
+      uint32_t      site_alg;          // the algorithm of that choice
+      uint32_t      installed_alg;     // the algorithm of my barriers
+      bool          read_only;         // declared read-only at begin
+      uint32_t      num_ro_writes;     // stats counter: writes in those
 
       /*** POINTERS TO INSTRUMENTATION */
 
@@ -126,8 +159,12 @@ namespace stm
        * to rollback the top level of nesting without actually unwinding the
        * stack. Rollback behavior changes per-implementation (some, such as
        * CGL, can't rollback) so we add it here.
+       *
+       * This is per-thread, because during a non-blocking algorithm switch a
+       * transaction that started under the old algorithm must also roll back
+       * under the old algorithm.
        */
-      static scope_t* (*tmrollback)(STM_ROLLBACK_SIG(,,));
+      scope_t* (*tmrollback)(STM_ROLLBACK_SIG(,,));
 
       /**
        * The function for aborting a transaction. The "tmabort" function is
@@ -143,6 +180,9 @@ namespace stm
       /*** how to become irrevocable in-flight */
       static bool(*tmirrevoc)(TxThread*);
 
+      /*** are algorithms chosen per atomic block?  (see sites.cpp) */
+      static bool site_select;
+
       /**
        * for shutting down threads.  Currently a no-op.
        */
@@ -161,6 +201,14 @@ namespace stm
   /*** GLOBAL VARIABLES RELATED TO THREAD MANAGEMENT */
   extern __thread TxThread* Self; // this thread's TxThread
 
+  /**
+   *  The scope of every stm::atomic() transaction (see api/library.hpp).
+   *  When the default abort handler rolls back to this scope, it throws an
+   *  atomic_restart instead of calling longjmp.
+   */
+  extern char atomic_scope;
+  struct atomic_restart { };
+
 } // namespace stm
 
 #endif // TXTHREAD_HPP__
@@ -0,0 +1,175 @@
+/**
+ *  Copyright (C) 2011
+ *  University of Rochester Department of Computer Science
+ *    and
+ *  Lehigh University Department of Computer Science and Engineering
+ *
+ * License: Modified BSD
+ *          Please see the file LICENSE.RSTM for licensing information
+ */
+
+/**
+ *  This file implements the slow paths of SlabPool (see
+ *  include/stm/SlabPool.hpp).
+ *
+ *  We reserve a large region with MAP_NORESERVE, so that pages only cost
+ *  memory once a span is carved from them, and hand out spans from it with
+ *  a fetch-and-add.  Each thread's inbox is a stack of batches: any thread
+ *  may push a batch with a CAS, and only the owner ever takes from it, by
+ *  swapping the whole stack out, so there is no ABA problem.
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <sys/mman.h>
+#include <stm/WBMMPolicy.hpp> // threadcount
+
+using namespace stm;
+
+namespace
+{
+  /**
+   *  the biggest reservation we try for, and the smallest we accept.  A
+   *  32-bit size_t can't shift by 36, and its address space couldn't hold
+   *  that much anyway.
+   */
+  const size_t MAX_RESERVE =
+      (sizeof(void*) == 8) ? (size_t)1 << 36 : (size_t)1 << 30;
+  const size_t MIN_RESERVE = (size_t)1 << 30;
+
+  /*** the size of each class's blocks */
+  size_t class_size(uint32_t c)
+  {
+      if (c < 8)
+          return 16 * (c + 1);
+      uint32_t b = 7 + (c - 8) / 4;
+      return (size_t)(4 + (c - 8) % 4 + 1) << (b - 2);
+  }
+
+  /*** the next unused span of the reservation */
+  volatile uintptr_t next_span = 0;
+
+  /*** each thread's stack of batches of blocks that others freed */
+  SlabPool::block_t* volatile inbox[MAX_THREADS] = {0};
+
+  /*** give a batch to its owner */
+  void push_batch(uint32_t to, SlabPool::block_t* head)
+  {
+      SlabPool::block_t* old;
+      do {
+          old = inbox[to];
+          head->next_batch = old;
+      } while (!bcasptr(&inbox[to], old, head));
+  }
+}
+
+char* SlabPool::base = NULL;
+char* SlabPool::limit = NULL;
+SlabPool::span_t* SlabPool::spans = NULL;
+
+void SlabPool::init()
+{
+    if (base || !getenv("STM_SLABS"))
+        return;
+    for (size_t size = MAX_RESERVE; size >= MIN_RESERVE; size /= 2) {
+        void* r = mmap(NULL, size, PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+        if (r == MAP_FAILED)
+            continue;
+        size_t table = (size / SPAN) * sizeof(span_t);
+        void* t = mmap(NULL, table, PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+        if (t == MAP_FAILED) {
+            munmap(r, size);
+            continue;
+        }
+        // spans must be SPAN-aligned so that spanOf works; mmap gives us
+        // page alignment, so we just start at the first aligned address
+        uintptr_t first = ((uintptr_t)r + SPAN - 1) & ~(uintptr_t)(SPAN - 1);
+        spans = (span_t*)t;
+        next_span = first;
+        limit = (char*)r + size;
+        base = (char*)first;
+        return;
+    }
+    printf("STM_SLABS: could not reserve address space; using malloc\n");
+}
+
+SlabPool::SlabPool() : owner(0), outgoing(NULL)
+{
+    for (uint32_t c = 0; c < CLASSES; ++c) {
+        free_lists[c] = NULL;
+        bump[c] = bump_end[c] = NULL;
+    }
+}
+
+void* SlabPool::refill(uint32_t c, size_t size)
+{
+    // first, take back everything that other threads have freed
+    if (inbox[owner]) {
+        block_t* batch = (block_t*)atomicswapptr(&inbox[owner], 0);
+        while (batch) {
+            block_t* next_batch = batch->next_batch;
+            block_t* b = batch;
+            while (b) {
+                block_t* next = b->next;
+                uint8_t cls = spans[spanOf(b)].cls;
+                b->next = free_lists[cls];
+                free_lists[cls] = b;
+                b = next;
+            }
+            batch = next_batch;
+        }
+        if (block_t* b = free_lists[c]) {
+            free_lists[c] = b->next;
+            return b;
+        }
+    }
+
+    // next, carve a block from this class's span, or from a new span
+    size_t bytes = class_size(c);
+    if (bump[c] + bytes > bump_end[c]) {
+        char* s = (char*)faaptr(&next_span, SPAN);
+        if (s + SPAN > limit)
+            return malloc(size);
+        span_t& info = spans[spanOf(s)];
+        info.owner = owner;
+        info.cls = c;
+        bump[c] = s;
+        bump_end[c] = s + SPAN;
+    }
+    void* p = bump[c];
+    bump[c] += bytes;
+    return p;
+}
+
+void SlabPool::sendRemote(void* p, uint32_t to)
+{
+    if (!outgoing)
+        outgoing = (batch_t*)calloc(MAX_THREADS, sizeof(batch_t));
+    batch_t& out = outgoing[to];
+    block_t* b = (block_t*)p;
+    b->next = out.head;
+    out.head = b;
+    if (++out.count < BATCH)
+        return;
+
+    push_batch(to, out.head);
+    out.head = NULL;
+    out.count = 0;
+}
+
+void SlabPool::flush()
+{
+    if (!outgoing)
+        return;
+    for (uint32_t i = 0; i < threadcount.val; ++i) {
+        batch_t& out = outgoing[i];
+        if (!out.count)
+            continue;
+        push_batch(i, out.head);
+        out.head = NULL;
+        out.count = 0;
+    }
+}
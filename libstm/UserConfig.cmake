@@ -97,6 +97,56 @@ option(
   "ON enables a histogram of consecutive aborts" OFF)
 #mark_as_advanced(libstm_enable_abort_histogram)
 
+## Experimental: to find out which locations cause aborts, each thread can
+##               log the cause of its recent aborts.  This only costs a few
+##               stores per abort.  Set STM_HOTSPOTS to see a report.
+option(
+  libstm_enable_conflict_attribution
+  "ON records the cause of each abort for a hotspot report" ON)
+
+## Each thread can keep histograms of transaction latency, commit latency,
+## and retries, for a percentile report at shutdown.  This costs one tick()
+## and a few increments per commit.
+option(
+  libstm_enable_latency_histograms
+  "ON enables per-thread latency histograms" ON)
+
+## Overhead: memory that the current transaction allocated cannot conflict
+##           with anyone, so TM_READ and TM_WRITE can access it directly.
+##           This costs a range check on every barrier, which is more than
+##           it saves unless fresh nodes are written through TM_WRITE and
+##           the algorithm's writes are expensive (e.g., eager locking).
+option(
+  libstm_enable_capture_analysis
+  "ON skips barriers on memory allocated by the same transaction" OFF)
+
+## Overhead: every barrier is an indirect call, so that adaptivity can swap
+##           algorithms.  For each algorithm listed here, we also build
+##           stm<arch><alg>, which only runs that algorithm, and which
+##           programs built with STM_STATIC_DISPATCH_<alg> can call without
+##           the indirection (see include/stm/static_dispatch.hpp).  The
+##           benchmarks are also built against each one, as <bench>SSB<arch><alg>.
+libstm_enum_list(
+  libstm_static_dispatch none
+  "Algorithms to also build as static-dispatch libraries"
+  CGL;TML;NOrec)
+
+## Experimental: to see whether an algorithm loses on cache misses or on
+##               instruction count, each thread can read hardware counters
+##               (Linux perf_event) around every transaction attempt.  This
+##               costs two system calls per attempt.
+option(
+  libstm_enable_perf_counters
+  "ON counts cycles, instructions and LLC misses per algorithm" OFF)
+
+## Experimental: a timeline of transaction events (begin, commit, abort,
+##               switch, irrevocable) helps to diagnose throughput
+##               collapses.  Set STM_TRACE to the output file, and use
+##               tools/stmtrace to read it.
+option(
+  libstm_enable_tracing
+  "ON enables the binary transaction event tracer" OFF)
+
 ## Overhead: The C++ TM Draft Standard requires byte-level granularity of
 ##           instrumentation since tx/nontx accesses to adjacent bytes are
 ##           allowed.  This is forced on when building the shim, and usually
@@ -8,11 +8,74 @@
  *          Please see the file LICENSE.RSTM for licensing information
  */
 
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <pthread.h>
+#include <unistd.h>
 #include <stm/WBMMPolicy.hpp>
 using namespace stm;
 
 namespace
 {
+  /**
+   *  The background reclaimer.  Committers push chains of reclaimable
+   *  nodes onto a stack with a CAS, and the reclaimer swaps the whole stack
+   *  out, so there is no ABA problem.  'backlog' counts the nodes that have
+   *  been pushed but not yet freed.
+   */
+  const uintptr_t MAX_BACKLOG = 256;
+
+  limbo_t* volatile   reclaim_queue = NULL;
+  volatile uintptr_t  backlog = 0;
+  volatile bool       handoff = false;   // may committers push?
+  volatile bool       stopping = false;
+  pthread_t           reclaimer;
+
+  /*** free every block of every node in a chain, then the nodes */
+  void reclaim_chain(limbo_t* node, SlabPool& pool)
+  {
+      while (node) {
+          for (unsigned long i = 0; i < limbo_t::POOL_SIZE; i++)
+              pool.release(node->pool[i]);
+          limbo_t* next = node->newer;
+          free(node);
+          faaptr(&backlog, -1);
+          node = next;
+      }
+      pool.flush();
+  }
+
+  void* reclaimer_main(void*)
+  {
+      // this pool owns no spans, so slab blocks go back to their owners
+      SlabPool pool;
+      pool.setID(MAX_THREADS);
+      while (true) {
+          limbo_t* chain = (limbo_t*)atomicswapptr(&reclaim_queue, 0);
+          if (chain)
+              reclaim_chain(chain, pool);
+          else if (stopping)
+              return NULL;
+          else
+              usleep(100);
+      }
+  }
+
+  /*** give a chain of n nodes to the reclaimer, unless it is behind */
+  bool hand_off(limbo_t* first, limbo_t* last, uint32_t n)
+  {
+      if (!handoff || (backlog + n > MAX_BACKLOG))
+          return false;
+      faaptr(&backlog, n);
+      limbo_t* old;
+      do {
+          old = reclaim_queue;
+          last->newer = old;
+      } while (!bcasptr(&reclaim_queue, old, first));
+      return true;
+  }
+
   /*** figure out if one timestamp is strictly dominated by another */
   inline bool
   is_strictly_older(uint32_t* newer, uint32_t* older, uint32_t old_len)
@@ -30,45 +93,119 @@ pad_word_t stm::trans_nums[MAX_THREADS] = {{0}};
 //       mean it will not reclaim some things as early as it might otherwise?
 void WBMMPolicy::handle_full_prelimbo()
 {
-    // get the current timestamp from the epoch
-    prelimbo->length = threadcount.val;
-    for (uint32_t i = 0, e = prelimbo->length; i < e; ++i)
-        prelimbo->ts[i] = trans_nums[i].val;
-
-    // push prelimbo onto the front of the limbo list:
-    prelimbo->older = limbo;
-    limbo = prelimbo;
-
-    //  check if anything after limbo->head is dominated by ts.  Exit the loop
-    //  when the list is empty, or when we find something that is strictly
-    //  dominated.
-    //
-    //  NB: the list is in sorted order by timestamp.
-    limbo_t* current = limbo->older;
-    limbo_t* prev = limbo;
-    while (current != NULL) {
-        if (is_strictly_older(limbo->ts, current->ts, current->length))
-            break;
-        prev = current;
-        current = current->older;
+    // seal the prelimbo pool into a node with the current timestamp, sized
+    // for the threads that exist right now.  Usually we can reuse a node
+    // that we emptied earlier, which keeps the limbo list out of malloc.
+    uint32_t count = threadcount.val;
+    limbo_t* node = spare;
+    if (node && node->capacity >= count) {
+        spare = node->newer;
+        --spare_count;
+    }
+    else {
+        node = (limbo_t*)malloc(offsetof(limbo_t, ts)
+                                + count * sizeof(uint32_t));
+        node->capacity = count;
     }
+    memcpy(node->pool, prelimbo, sizeof(node->pool));
+    prelimbo_length = 0;
+    node->newer = NULL;
+    node->length = count;
+    for (uint32_t i = 0; i < count; ++i)
+        node->ts[i] = trans_nums[i].val;
 
-    // If current != NULL, it is the head of a list of reclaimables
-    if (current) {
-        // detach /current/ from the list
-        prev->older = NULL;
+    // append the node to the limbo list
+    if (newest)
+        newest->newer = node;
+    else
+        limbo = node;
+    newest = node;
 
-        // free all blocks in each node's pool and free the node
-        while (current != NULL) {
-            // free blocks in current's pool
-            for (unsigned long i = 0; i < current->POOL_SIZE; i++)
-                free(current->pool[i]);
+    //  The list is in sorted order by timestamp, so everything that /node/
+    //  strictly dominates is at the old end of the list.  Unlink nodes from
+    //  there until we find a node that isn't dominated.
+    limbo_t* first = limbo;
+    limbo_t* last = NULL;
+    uint32_t n = 0;
+    while (limbo != node && is_strictly_older(node->ts, limbo->ts, limbo->length))
+    {
+        last = limbo;
+        limbo = limbo->newer;
+        ++n;
+    }
+    if (!n)
+        return;
+    last->newer = NULL;
+    if (hand_off(first, last, n))
+        return;
+
+    // free them ourselves
+    while (first) {
+        // free blocks in the oldest node's pool
+        for (unsigned long i = 0; i < limbo_t::POOL_SIZE; i++)
+            slabs.release(first->pool[i]);
 
-            // free the node and move on
-            limbo_t* old = current;
-            current = current->older;
+        // keep a few nodes for next time
+        limbo_t* old = first;
+        first = first->newer;
+        if ((old->capacity >= count) && (spare_count < MAX_SPARE)) {
+            old->newer = spare;
+            spare = old;
+            ++spare_count;
+        }
+        else {
             free(old);
         }
     }
-    prelimbo = new limbo_t();
+
+    // blocks that other threads own go back to them in batches
+    slabs.flush();
+}
+
+void* WBMMPolicy::unstash(size_t size)
+{
+    for (uint32_t i = 0; i < stash_count; ++i) {
+        if (stash[i].size == size) {
+            void* ptr = stash[i].ptr;
+            stash[i] = stash[--stash_count];
+            ++stash_hits;
+            return ptr;
+        }
+    }
+    ++stash_misses;
+    return NULL;
+}
+
+void WBMMPolicy::clear_stash()
+{
+    for (uint32_t i = 0; i < stash_count; ++i)
+        slabs.release(stash[i].ptr);
+    stash_count = 0;
+    retrying = false;
+}
+
+void WBMMPolicy::startReclaimer()
+{
+    const char* env = getenv("STM_RECLAIMER");
+    if (handoff || !env || !strtol(env, 0, 10))
+        return;
+    if (pthread_create(&reclaimer, NULL, reclaimer_main, NULL)) {
+        printf("STM_RECLAIMER: could not start the reclaimer thread\n");
+        return;
+    }
+    handoff = true;
+}
+
+/**
+ *  Stop taking new work, and wait for the reclaimer to drain the queue.  A
+ *  committer that is racing with this may still push a chain after the
+ *  reclaimer exits; since we only stop at shutdown, we let that leak.
+ */
+void WBMMPolicy::stopReclaimer()
+{
+    if (!handoff)
+        return;
+    handoff = false;
+    stopping = true;
+    pthread_join(reclaimer, NULL);
 }
@@ -68,6 +68,7 @@ namespace stm
   static const uint32_t ACTIVE        = 0;        // transaction status
   static const uint32_t ABORTED       = 1;        // transaction status
   static const uint32_t SWISS_PHASE2  = 10; // swisstm cm phase change thresh
+  static const uint32_t DEFERRED_WAIT = 64; // yields b4 deferred op aborts
 
   /**
    *  These global fields are used for concurrency control and conflict
@@ -95,6 +96,15 @@ namespace stm
   extern dynprof_t*    profiles;          // a list of ProfileTM measurements
   extern uint32_t      profile_txns;      // how many txns per profile
 
+  /**
+   *  Algorithms that interpret the shared metadata identically can have
+   *  transactions in flight at the same time.  We tag each algorithm with its
+   *  metadata family, so that switching within a family does not need to
+   *  wait for in-flight transactions to drain (see install_algorithm_lazy).
+   *  Everything else is NoFamily, and always switches via begin_blocker.
+   */
+  enum FAMILIES { NoFamily = 0, SeqlockFamily, OrecFamily };
+
   /**
    *  To describe an STM algorithm, we provide a name, a set of function
    *  pointers, and some other information
@@ -113,6 +123,34 @@ namespace stm
       void* (*TM_FASTCALL read)  (STM_READ_SIG(,,));
       void  (*TM_FASTCALL write) (STM_WRITE_SIG(,,,));
 
+      /**
+       * cheaper read and commit methods for transactions that are declared
+       * read-only (see begin_read_only), or NULL to use read and commit
+       */
+      void* (*TM_FASTCALL ro_read)  (STM_READ_SIG(,,));
+      void  (*TM_FASTCALL ro_commit)(TxThread*);
+
+      /**
+       * bulk versions of read and write, for the range calls of the library
+       * API (see range.cpp), or NULL to call read or write once per word.
+       * They copy 'words' aligned words between addr and a buffer that need
+       * not be aligned, and are only used while the thread's barrier is the
+       * algorithm's read (or ro_read) or write.
+       */
+      void  (*TM_FASTCALL read_range) (TxThread*, void** addr, void* buf,
+                                       size_t words);
+      void  (*TM_FASTCALL write_range)(TxThread*, void** addr,
+                                       const void* buf, size_t words);
+
+      /**
+       * switches the transaction to the barriers whose commit does its
+       * commutative updates (tx->deferred; see deferred.hpp) while it holds
+       * the locations' locks, or NULL if the algorithm can't, in which case
+       * the updates are replayed through read and write.  Only used while
+       * the thread's rollback is the algorithm's.
+       */
+      void  (*TM_FASTCALL defer)(TxThread*);
+
       /**
        * rolls the transaction back without unwinding, returns the scope (which
        * is set to null during rollback)
@@ -133,8 +171,14 @@ namespace stm
        */
       bool privatization_safe;
 
+      /*** the metadata family, for non-blocking switching */
+      int family;
+
       /*** simple ctor, because a NULL name is a bad thing */
-      alg_t() : name("") { }
+      alg_t()
+          : name(""), ro_read(NULL), ro_commit(NULL), read_range(NULL),
+            write_range(NULL), defer(NULL), family(NoFamily)
+      { }
   };
 
   /**
@@ -294,10 +338,101 @@ namespace stm
       tx->tmcommit = commit_rw;
   }
 
+  /**
+   *  Abort because of a conflict, noting its kind and the orec, lock, or
+   *  address involved (and the address being accessed, if there is one)
+   *  for the hotspot report.
+   */
+  NORETURN inline void ConflictAbort(TxThread* tx, conflict_kind_t kind,
+                                     const void* where,
+                                     const void* addr = NULL)
+  {
+      tx->conflicts.note(kind, where, addr);
+      tx->tmabort(tx);
+  }
+
+  /**
+   *  Commutative updates (see deferred.hpp), for a commit-time locking
+   *  commit.  The transaction never read the locations, so any version of
+   *  their orecs will do, as long as nobody holds them.  But if it read
+   *  something else that shares an orec with one of them, validation has to
+   *  check the version we replaced, which we keep in o->p.
+   */
+  inline void AcquireDeferred(TxThread* tx)
+  {
+      foreach (DeferredList, i, tx->deferred) {
+          orec_t* o = get_orec(i->addr);
+          // nothing we read depends on the orec, so if another commit holds
+          // it, wait a little for it to be released.  The wait is bounded,
+          // since two commits can each hold an orec the other needs.
+          for (unsigned tries = 0; ; ++tries) {
+              id_version_t ivt;
+              ivt.all = o->v.all;
+              if (ivt.all == tx->my_lock.all)
+                  break;
+              if (!ivt.fields.lock &&
+                  bcasptr(&o->v.all, ivt.all, tx->my_lock.all))
+              {
+                  o->p = ivt.all;
+                  tx->locks.insert(o);
+                  break;
+              }
+              if (tries == DEFERRED_WAIT)
+                  ConflictAbort(tx, CONFLICT_LOCKED, o, i->addr);
+              yield_cpu();
+          }
+      }
+  }
+
+  /*** do the commutative updates, once the commit holds their locks */
+  inline void WritebackDeferred(TxThread* tx)
+  {
+      foreach (DeferredList, i, tx->deferred)
+          i->update(i->addr, i->val);
+  }
+
+  /**
+   *  When value-based validation fails, note the first location whose value
+   *  changed.  We only pay for the search on the failure path.
+   */
+  inline void NoteValueConflict(TxThread* tx)
+  {
+#ifdef STM_CONFLICTS_YES
+      foreach (ValueList, i, tx->vlist) {
+          bool valid = STM_LOG_VALUE_IS_VALID(i, tx);
+          if (!valid) {
+              tx->conflicts.note(CONFLICT_VALIDATION, i->getAddress(),
+                                 i->getAddress());
+              return;
+          }
+      }
+#endif
+  }
+
+  /**
+   *  Once a transaction has rolled back, run its on_abort() handlers, most
+   *  recent first, and forget its on_commit() handlers.
+   */
+  inline void RunAbortHandlers(TxThread* tx)
+  {
+      for (HandlerList::iterator i = tx->abort_handlers.end();
+           i != tx->abort_handlers.begin(); )
+      {
+          --i;
+          i->fn(i->arg);
+      }
+      tx->abort_handlers.reset();
+      tx->commit_handlers.reset();
+  }
+
   inline void PreRollback(TxThread* tx)
   {
       ++tx->num_aborts;
       ++tx->consec_aborts;
+      tx->trace.record(tick(), TRACE_ABORT, tx->conflicts.pending(),
+                       trace_reads(tx), trace_writes(tx));
+      tx->conflicts.onAbort(tx->site);
+      tx->perf.onAbort();
   }
 
   inline scope_t* PostRollback(TxThread* tx, ReadBarrier read_ro,
@@ -305,6 +440,7 @@ namespace stm
   {
       tx->allocator.onTxAbort();
       tx->nesting_depth = 0;
+      RunAbortHandlers(tx);
       tx->tmread = read_ro;
       tx->tmwrite = write_ro;
       tx->tmcommit = commit_ro;
@@ -318,6 +454,7 @@ namespace stm
   {
       tx->allocator.onTxAbort();
       tx->nesting_depth = 0;
+      RunAbortHandlers(tx);
       Trigger::onAbort(tx);
       scope_t* scope = tx->scope;
       tx->scope = NULL;
@@ -337,6 +474,7 @@ namespace stm
   {
       tx->allocator.onTxAbort();
       tx->nesting_depth = 0;
+      RunAbortHandlers(tx);
       tx->tmread = r;
       tx->tmwrite = w;
       tx->tmcommit = c;
@@ -355,6 +493,7 @@ namespace stm
   {
       tx->allocator.onTxAbort();
       tx->nesting_depth = 0;
+      RunAbortHandlers(tx);
       scope_t* scope = tx->scope;
       tx->scope = NULL;
       return scope;
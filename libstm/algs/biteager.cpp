@@ -26,6 +26,7 @@ using stm::bitlock_t;
 using stm::get_bitlock;
 using stm::rrec_t;
 using stm::UndoLogEntry;
+using stm::CONFLICT_LOCKED;
 
 
 /**
@@ -136,7 +137,7 @@ namespace {
           lock->readers.unsetbit(tx->id-1);
           while (lock->owner != 0)
               if (++tries > READ_TIMEOUT)
-                  tx->tmabort(tx);
+                  ConflictAbort(tx, CONFLICT_LOCKED, lock, addr);
       }
   }
 
@@ -176,7 +177,7 @@ namespace {
           lock->readers.unsetbit(tx->id-1);
           while (lock->owner != 0)
               if (++tries > READ_TIMEOUT)
-                  tx->tmabort(tx);
+                  ConflictAbort(tx, CONFLICT_LOCKED, lock, addr);
       }
   }
 
@@ -195,7 +196,7 @@ namespace {
       // get the write lock, with timeout
       while (!bcasptr(&(lock->owner), 0u, tx->id))
           if (++tries > ACQUIRE_TIMEOUT)
-              tx->tmabort(tx);
+              ConflictAbort(tx, CONFLICT_LOCKED, lock, addr);
 
       // log the lock, drop any read locks I have
       tx->w_bitlocks.insert(lock);
@@ -207,7 +208,7 @@ namespace {
           tries = 0;
           while (lock->readers.bits[b])
               if (++tries > DRAIN_TIMEOUT)
-                  tx->tmabort(tx);
+                  ConflictAbort(tx, CONFLICT_LOCKED, lock, addr);
       }
 
       // add to undo log, do in-place write
@@ -238,7 +239,7 @@ namespace {
       // get the write lock, with timeout
       while (!bcasptr(&(lock->owner), 0u, tx->id))
           if (++tries > ACQUIRE_TIMEOUT)
-              tx->tmabort(tx);
+              ConflictAbort(tx, CONFLICT_LOCKED, lock, addr);
 
       // log the lock, drop any read locks I have
       tx->w_bitlocks.insert(lock);
@@ -253,7 +254,7 @@ namespace {
           tries = 0;
           while (lock->readers.bits[b])
               if (++tries > DRAIN_TIMEOUT)
-                  tx->tmabort(tx);
+                  ConflictAbort(tx, CONFLICT_LOCKED, lock, addr);
       }
 
       // add to undo log, do in-place write
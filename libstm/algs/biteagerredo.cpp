@@ -26,6 +26,7 @@ using stm::bitlock_t;
 using stm::get_bitlock;
 using stm::WriteSetEntry;
 using stm::rrec_t;
+using stm::CONFLICT_LOCKED;
 
 
 /**
@@ -139,7 +140,7 @@ namespace {
           lock->readers.unsetbit(tx->id-1);
           while (lock->owner != 0) {
               if (++tries > READ_TIMEOUT)
-                  tx->tmabort(tx);
+                  ConflictAbort(tx, CONFLICT_LOCKED, lock, addr);
           }
       }
   }
@@ -187,7 +188,7 @@ namespace {
           lock->readers.unsetbit(tx->id-1);
           while (lock->owner != 0) {
               if (++tries > READ_TIMEOUT)
-                  tx->tmabort(tx);
+                  ConflictAbort(tx, CONFLICT_LOCKED, lock, addr);
           }
       }
   }
@@ -206,7 +207,7 @@ namespace {
       // get the write lock, with timeout
       while (!bcasptr(&(lock->owner), 0u, tx->id))
           if (++tries > ACQUIRE_TIMEOUT)
-              tx->tmabort(tx);
+              ConflictAbort(tx, CONFLICT_LOCKED, lock, addr);
 
       // log the lock, drop any read locks I have
       tx->w_bitlocks.insert(lock);
@@ -218,7 +219,7 @@ namespace {
           tries = 0;
           while (lock->readers.bits[b])
               if (++tries > DRAIN_TIMEOUT)
-                  tx->tmabort(tx);
+                  ConflictAbort(tx, CONFLICT_LOCKED, lock, addr);
       }
 
       // record in redo log
@@ -247,7 +248,7 @@ namespace {
       // get the write lock, with timeout
       while (!bcasptr(&(lock->owner), 0u, tx->id))
           if (++tries > ACQUIRE_TIMEOUT)
-              tx->tmabort(tx);
+              ConflictAbort(tx, CONFLICT_LOCKED, lock, addr);
 
       // log the lock, drop any read locks I have
       tx->w_bitlocks.insert(lock);
@@ -259,7 +260,7 @@ namespace {
           tries = 0;
           while (lock->readers.bits[b])
               if (++tries > DRAIN_TIMEOUT)
-                  tx->tmabort(tx);
+                  ConflictAbort(tx, CONFLICT_LOCKED, lock, addr);
       }
 
       // record in redo log
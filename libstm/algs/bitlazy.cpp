@@ -41,6 +41,8 @@ using stm::bitlock_t;
 using stm::get_bitlock;
 using stm::threads;
 using stm::WriteSetEntry;
+using stm::CONFLICT_KILLED;
+using stm::CONFLICT_LOCKED;
 
 
 /**
@@ -82,7 +84,7 @@ namespace {
   {
       // were there remote aborts?
       if (!tx->alive)
-          tx->tmabort(tx);
+          ConflictAbort(tx, CONFLICT_KILLED, NULL);
       CFENCE;
 
       // release read locks
@@ -114,14 +116,14 @@ namespace {
           // abort if cannot acquire and haven't locked yet
           if (bl->owner == 0) {
               if (!bcasptr(&bl->owner, (uintptr_t)0, tx->my_lock.all))
-                  tx->tmabort(tx);
+                  ConflictAbort(tx, CONFLICT_LOCKED, bl, i->addr);
               // log lock
               tx->w_bitlocks.insert(bl);
               // get readers
               accumulator |= bl->readers;
           }
           else if (bl->owner != tx->my_lock.all) {
-              tx->tmabort(tx);
+              ConflictAbort(tx, CONFLICT_LOCKED, bl, i->addr);
           }
       }
 
@@ -149,7 +151,7 @@ namespace {
       // were there remote aborts?
       CFENCE;
       if (!tx->alive)
-          tx->tmabort(tx);
+          ConflictAbort(tx, CONFLICT_KILLED, NULL);
       CFENCE;
 
       // we committed... replay redo log
@@ -184,12 +186,12 @@ namespace {
           tx->r_bitlocks.insert(bl);
       // if there's a writer, it can't be me since I'm in-flight
       if (bl->owner)
-          tx->tmabort(tx);
+          ConflictAbort(tx, CONFLICT_LOCKED, bl, addr);
       // order the read before checking for remote aborts
       void* val = *addr;
       CFENCE;
       if (!tx->alive)
-          tx->tmabort(tx);
+          ConflictAbort(tx, CONFLICT_KILLED, NULL, addr);
       return val;
   }
 
@@ -217,12 +219,12 @@ namespace {
           REDO_RAW_CHECK(found, log, mask);
       }
       if (bl->owner)
-          tx->tmabort(tx);
+          ConflictAbort(tx, CONFLICT_LOCKED, bl, addr);
       void* val = *addr;
       REDO_RAW_CLEANUP(val, found, log, mask);
       CFENCE;
       if (!tx->alive)
-          tx->tmabort(tx);
+          ConflictAbort(tx, CONFLICT_KILLED, NULL, addr);
       return val;
   }
 
@@ -242,7 +244,7 @@ namespace {
       if (bl->readers.setif(tx->id-1))
           tx->r_bitlocks.insert(bl);
       if (bl->owner)
-          tx->tmabort(tx);
+          ConflictAbort(tx, CONFLICT_LOCKED, bl, addr);
       OnFirstWrite(tx, read_rw, write_rw, commit_rw);
   }
 
@@ -260,7 +262,7 @@ namespace {
       if (bl->readers.setif(tx->id-1))
           tx->r_bitlocks.insert(bl);
       if (bl->owner)
-          tx->tmabort(tx);
+          ConflictAbort(tx, CONFLICT_LOCKED, bl, addr);
   }
 
   /**
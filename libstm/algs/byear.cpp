@@ -26,6 +26,8 @@ using stm::bytelock_t;
 using stm::get_bytelock;
 using stm::WriteSetEntry;
 using stm::threads;
+using stm::CONFLICT_KILLED;
+using stm::CONFLICT_LOCKED;
 
 
 /**
@@ -89,7 +91,7 @@ namespace {
   {
       // atomically mark self committed
       if (!bcas32(&tx->alive, TX_ACTIVE, TX_COMMITTED))
-          tx->tmabort(tx);
+          ConflictAbort(tx, CONFLICT_KILLED, NULL);
 
       // we committed... replay redo log
       tx->writes.writeback();
@@ -128,11 +130,11 @@ namespace {
           switch (threads[owner-1]->alive) {
             case TX_COMMITTED:
               // abort myself if the owner is writing back
-              tx->tmabort(tx);
+              ConflictAbort(tx, CONFLICT_LOCKED, lock, addr);
             case TX_ACTIVE:
               // abort the owner(it's active)
               if (!bcas32(&threads[owner-1]->alive, TX_ACTIVE, TX_ABORTED))
-                  tx->tmabort(tx);
+                  ConflictAbort(tx, CONFLICT_LOCKED, lock, addr);
               break;
             case TX_ABORTED:
               // if the owner is unwinding, go through and read
@@ -147,7 +149,7 @@ namespace {
 
       // check for remote abort
       if (tx->alive == TX_ABORTED)
-          tx->tmabort(tx);
+          ConflictAbort(tx, CONFLICT_KILLED, NULL, addr);
       return result;
   }
 
@@ -184,11 +186,11 @@ namespace {
           switch (threads[owner-1]->alive) {
             case TX_COMMITTED:
               // abort myself if the owner is writing back
-              tx->tmabort(tx);
+              ConflictAbort(tx, CONFLICT_LOCKED, lock, addr);
             case TX_ACTIVE:
               // abort the owner(it's active)
               if (!bcas32(&threads[owner-1]->alive, TX_ACTIVE, TX_ABORTED))
-                  tx->tmabort(tx);
+                  ConflictAbort(tx, CONFLICT_LOCKED, lock, addr);
               break;
             case TX_ABORTED:
               // if the owner is unwinding, go through and read
@@ -203,7 +205,7 @@ namespace {
 
       // check for remote abort
       if (tx->alive == TX_ABORTED)
-          tx->tmabort(tx);
+          ConflictAbort(tx, CONFLICT_KILLED, NULL, addr);
 
       return result;
   }
@@ -226,7 +228,7 @@ namespace {
               break;
           // liveness check
           if (tx->alive == TX_ABORTED)
-              tx->tmabort(tx);
+              ConflictAbort(tx, CONFLICT_KILLED, NULL, addr);
       }
 
       // log the lock, drop any read locks I have
@@ -242,7 +244,7 @@ namespace {
       for (int i = 0; i < 60; ++i)
           if (lock->reader[i] != 0 && threads[i]->alive == TX_ACTIVE)
               if (!bcas32(&threads[i]->alive, TX_ACTIVE, TX_ABORTED))
-                  tx->tmabort(tx);
+                  ConflictAbort(tx, CONFLICT_LOCKED, lock, addr);
 
       // add to redo log
       tx->writes.insert(WriteSetEntry(STM_WRITE_SET_ENTRY(addr, val, mask)));
@@ -274,7 +276,7 @@ namespace {
               break;
           // liveness check
           if (tx->alive == TX_ABORTED)
-              tx->tmabort(tx);
+              ConflictAbort(tx, CONFLICT_KILLED, NULL, addr);
       }
 
       // log the lock, drop any read locks I have
@@ -285,7 +287,7 @@ namespace {
       for (int i = 0; i < 60; ++i)
           if (lock->reader[i] != 0 && threads[i]->alive == TX_ACTIVE)
               if (!bcas32(&threads[i]->alive, TX_ACTIVE, TX_ABORTED))
-                  tx->tmabort(tx);
+                  ConflictAbort(tx, CONFLICT_LOCKED, lock, addr);
 
       // add to redo log
       tx->writes.insert(WriteSetEntry(STM_WRITE_SET_ENTRY(addr, val, mask)));
@@ -39,6 +39,8 @@ using stm::bytelock_t;
 using stm::get_bytelock;
 using stm::threads;
 using stm::UndoLogEntry;
+using stm::CONFLICT_KILLED;
+using stm::CONFLICT_LOCKED;
 
 
 /**
@@ -176,11 +178,11 @@ namespace {
           if (CM::mayKill(tx, owner - 1))
               threads[owner-1]->alive = TX_ABORTED;
           else
-              tx->tmabort(tx);
+              ConflictAbort(tx, CONFLICT_LOCKED, lock, addr);
           // NB: must have liveness check in the spin, since we may have read
           //     locks
           if (tx->alive == TX_ABORTED)
-              tx->tmabort(tx);
+              ConflictAbort(tx, CONFLICT_KILLED, NULL, addr);
       }
 
       // do the read
@@ -190,7 +192,7 @@ namespace {
 
       // check for remote abort
       if (tx->alive == TX_ABORTED)
-          tx->tmabort(tx);
+          ConflictAbort(tx, CONFLICT_KILLED, NULL, addr);
       return result;
   }
 
@@ -218,10 +220,10 @@ namespace {
               if (CM::mayKill(tx, owner - 1))
                   threads[owner-1]->alive = TX_ABORTED;
               else
-                  tx->tmabort(tx);
+                  ConflictAbort(tx, CONFLICT_LOCKED, lock, addr);
               // NB: again, need liveness check
               if (tx->alive == TX_ABORTED)
-                  tx->tmabort(tx);
+                  ConflictAbort(tx, CONFLICT_KILLED, NULL, addr);
           }
       }
 
@@ -232,7 +234,7 @@ namespace {
 
       // check for remote abort
       if (tx->alive == TX_ABORTED)
-          tx->tmabort(tx);
+          ConflictAbort(tx, CONFLICT_KILLED, NULL, addr);
       return result;
   }
 
@@ -253,13 +255,13 @@ namespace {
               if (CM::mayKill(tx, owner - 1))
                   threads[owner-1]->alive = TX_ABORTED;
               else
-                  tx->tmabort(tx);
+                  ConflictAbort(tx, CONFLICT_LOCKED, lock, addr);
           // try to get ownership
           else if (bcas32(&(lock->owner), 0u, tx->id))
               break;
           // liveness check
           if (tx->alive == TX_ABORTED)
-              tx->tmabort(tx);
+              ConflictAbort(tx, CONFLICT_KILLED, NULL, addr);
       }
 
       // log the lock, drop any read locks I have
@@ -273,7 +275,7 @@ namespace {
               if (CM::mayKill(tx, i))
                   threads[i]->alive = TX_ABORTED;
               else
-                  tx->tmabort(tx);
+                  ConflictAbort(tx, CONFLICT_LOCKED, lock, addr);
           }
 
       // add to undo log, do in-place write
@@ -282,7 +284,7 @@ namespace {
 
       // check for remote abort
       if (tx->alive == TX_ABORTED)
-          tx->tmabort(tx);
+          ConflictAbort(tx, CONFLICT_KILLED, NULL, addr);
 
       OnFirstWrite(tx, read_rw, write_rw, commit_rw);
   }
@@ -306,13 +308,13 @@ namespace {
                   if (CM::mayKill(tx, owner-1))
                       threads[owner-1]->alive = TX_ABORTED;
                   else
-                      tx->tmabort(tx);
+                      ConflictAbort(tx, CONFLICT_LOCKED, lock, addr);
               // try to get ownership
               else if (bcas32(&(lock->owner), 0u, tx->id))
                   break;
               // liveness check
               if (tx->alive == TX_ABORTED)
-                  tx->tmabort(tx);
+                  ConflictAbort(tx, CONFLICT_KILLED, NULL, addr);
           }
           // log the lock, drop any read locks I have
           tx->w_bytelocks.insert(lock);
@@ -325,7 +327,7 @@ namespace {
                   if (CM::mayKill(tx, i))
                       threads[i]->alive = TX_ABORTED;
                   else
-                      tx->tmabort(tx);
+                      ConflictAbort(tx, CONFLICT_LOCKED, lock, addr);
               }
       }
 
@@ -335,7 +337,7 @@ namespace {
 
       // check for remote abort
       if (tx->alive == TX_ABORTED)
-          tx->tmabort(tx);
+          ConflictAbort(tx, CONFLICT_KILLED, NULL, addr);
   }
 
   /**
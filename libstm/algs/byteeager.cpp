@@ -25,6 +25,7 @@ using stm::ByteLockList;
 using stm::bytelock_t;
 using stm::get_bytelock;
 using stm::UndoLogEntry;
+using stm::CONFLICT_LOCKED;
 
 
 /**
@@ -132,7 +133,7 @@ namespace {
           lock->reader[tx->id-1] = 0;
           while (lock->owner != 0) {
               if (++tries > READ_TIMEOUT)
-                  tx->tmabort(tx);
+                  ConflictAbort(tx, CONFLICT_LOCKED, lock, addr);
           }
       }
   }
@@ -169,7 +170,7 @@ namespace {
           lock->reader[tx->id-1] = 0;
           while (lock->owner != 0)
               if (++tries > READ_TIMEOUT)
-                  tx->tmabort(tx);
+                  ConflictAbort(tx, CONFLICT_LOCKED, lock, addr);
       }
   }
 
@@ -185,7 +186,7 @@ namespace {
       // get the write lock, with timeout
       while (!bcas32(&(lock->owner), 0u, tx->id))
           if (++tries > ACQUIRE_TIMEOUT)
-              tx->tmabort(tx);
+              ConflictAbort(tx, CONFLICT_LOCKED, lock, addr);
 
       // log the lock, drop any read locks I have
       tx->w_bytelocks.insert(lock);
@@ -198,7 +199,7 @@ namespace {
           tries = 0;
           while (lock_alias[i] != 0)
               if (++tries > DRAIN_TIMEOUT)
-                  tx->tmabort(tx);
+                  ConflictAbort(tx, CONFLICT_LOCKED, lock, addr);
       }
 
       // add to undo log, do in-place write
@@ -227,7 +228,7 @@ namespace {
       // get the write lock, with timeout
       while (!bcas32(&(lock->owner), 0u, tx->id))
           if (++tries > ACQUIRE_TIMEOUT)
-              tx->tmabort(tx);
+              ConflictAbort(tx, CONFLICT_LOCKED, lock, addr);
 
       // log the lock, drop any read locks I have
       tx->w_bytelocks.insert(lock);
@@ -240,7 +241,7 @@ namespace {
           tries = 0;
           while (lock_alias[i] != 0)
               if (++tries > DRAIN_TIMEOUT)
-                  tx->tmabort(tx);
+                  ConflictAbort(tx, CONFLICT_LOCKED, lock, addr);
       }
 
       // add to undo log, do in-place write
@@ -25,6 +25,7 @@ using stm::ByteLockList;
 using stm::bytelock_t;
 using stm::get_bytelock;
 using stm::WriteSetEntry;
+using stm::CONFLICT_LOCKED;
 
 
 /**
@@ -135,7 +136,7 @@ namespace {
           lock->reader[tx->id-1] = 0;
           while (lock->owner != 0) {
               if (++tries > READ_TIMEOUT)
-                  tx->tmabort(tx);
+                  ConflictAbort(tx, CONFLICT_LOCKED, lock, addr);
           }
       }
   }
@@ -180,7 +181,7 @@ namespace {
           lock->reader[tx->id-1] = 0;
           while (lock->owner != 0) {
               if (++tries > READ_TIMEOUT)
-                  tx->tmabort(tx);
+                  ConflictAbort(tx, CONFLICT_LOCKED, lock, addr);
           }
       }
   }
@@ -197,7 +198,7 @@ namespace {
       // get the write lock, with timeout
       while (!bcas32(&(lock->owner), 0u, tx->id))
           if (++tries > ACQUIRE_TIMEOUT)
-              tx->tmabort(tx);
+              ConflictAbort(tx, CONFLICT_LOCKED, lock, addr);
 
       // log the lock, drop any read locks I have
       tx->w_bytelocks.insert(lock);
@@ -210,7 +211,7 @@ namespace {
           tries = 0;
           while (lock_alias[i] != 0)
               if (++tries > DRAIN_TIMEOUT)
-                  tx->tmabort(tx);
+                  ConflictAbort(tx, CONFLICT_LOCKED, lock, addr);
       }
 
       // record in redo log
@@ -237,7 +238,7 @@ namespace {
       // get the write lock, with timeout
       while (!bcas32(&(lock->owner), 0u, tx->id))
           if (++tries > ACQUIRE_TIMEOUT)
-              tx->tmabort(tx);
+              ConflictAbort(tx, CONFLICT_LOCKED, lock, addr);
 
       // log the lock, drop any read locks I have
       tx->w_bytelocks.insert(lock);
@@ -250,7 +251,7 @@ namespace {
           tries = 0;
           while (lock_alias[i] != 0)
               if (++tries > DRAIN_TIMEOUT)
-                  tx->tmabort(tx);
+                  ConflictAbort(tx, CONFLICT_LOCKED, lock, addr);
       }
 
       // record in redo log
@@ -27,6 +27,8 @@ using stm::bytelock_t;
 using stm::get_bytelock;
 using stm::WriteSetEntry;
 using stm::threads;
+using stm::CONFLICT_KILLED;
+using stm::CONFLICT_LOCKED;
 
 
 /**
@@ -69,7 +71,7 @@ namespace {
   {
       // were there remote aborts?
       if (!tx->alive)
-          tx->tmabort(tx);
+          ConflictAbort(tx, CONFLICT_KILLED, NULL);
       CFENCE;
 
       // release read locks
@@ -103,7 +105,7 @@ namespace {
           // abort if cannot acquire and haven't locked yet
           if (bl->owner == 0) {
               if (!bcas32(&bl->owner, (uintptr_t)0, tx->my_lock.all))
-                  tx->tmabort(tx);
+                  ConflictAbort(tx, CONFLICT_LOCKED, bl, i->addr);
 
               // log lock
               tx->w_bytelocks.insert(bl);
@@ -116,7 +118,7 @@ namespace {
                   p1[j] |= p2[j];
           }
           else if (bl->owner != tx->my_lock.all) {
-              tx->tmabort(tx);
+              ConflictAbort(tx, CONFLICT_LOCKED, bl, i->addr);
           }
       }
 
@@ -131,7 +133,7 @@ namespace {
       // were there remote aborts?
       CFENCE;
       if (!tx->alive)
-          tx->tmabort(tx);
+          ConflictAbort(tx, CONFLICT_KILLED, NULL);
       CFENCE;
 
       // we committed... replay redo log
@@ -169,14 +171,14 @@ namespace {
 
       // if there's a writer, it can't be me since I'm in-flight
       if (bl->owner != 0)
-          tx->tmabort(tx);
+          ConflictAbort(tx, CONFLICT_LOCKED, bl, addr);
 
       // order the read before checking for remote aborts
       void* val = *addr;
       CFENCE;
 
       if (!tx->alive)
-          tx->tmabort(tx);
+          ConflictAbort(tx, CONFLICT_KILLED, NULL, addr);
 
       return val;
   }
@@ -210,7 +212,7 @@ namespace {
 
       // if there's a writer, it can't be me since I'm in-flight
       if (bl->owner != 0)
-          tx->tmabort(tx);
+          ConflictAbort(tx, CONFLICT_LOCKED, bl, addr);
 
       // order the read before checking for remote aborts
       void* val = *addr;
@@ -218,7 +220,7 @@ namespace {
       CFENCE;
 
       if (!tx->alive)
-          tx->tmabort(tx);
+          ConflictAbort(tx, CONFLICT_KILLED, NULL, addr);
 
       return val;
   }
@@ -244,7 +246,7 @@ namespace {
       }
 
       if (bl->owner)
-          tx->tmabort(tx);
+          ConflictAbort(tx, CONFLICT_LOCKED, bl, addr);
 
       OnFirstWrite(tx, read_rw, write_rw, commit_rw);
   }
@@ -267,7 +269,7 @@ namespace {
       }
 
       if (bl->owner)
-          tx->tmabort(tx);
+          ConflictAbort(tx, CONFLICT_LOCKED, bl, addr);
   }
 
   /**
@@ -36,6 +36,8 @@ using stm::bytelock_t;
 using stm::get_bytelock;
 using stm::WriteSet;
 using stm::WriteSetEntry;
+using stm::CONFLICT_KILLED;
+using stm::CONFLICT_LOCKED;
 
 
 #define GET_WR_PRIO(x) (x >> 16)
@@ -97,7 +99,7 @@ namespace {
     BytePrio::commit_ro(TxThread* tx)
     {
 	if(!bcas32(&tx->alive, RUNNING, COMMITTING)){
-	    tx->tmabort(tx);
+	    ConflictAbort(tx, CONFLICT_KILLED, NULL);
 	}
 
 	// read-only... release read locks
@@ -115,7 +117,7 @@ namespace {
     BytePrio::commit_rw(TxThread* tx)
     {
 	if(!bcas32(&tx->alive, RUNNING, COMMITTING)){
-	    tx->tmabort(tx);
+	    ConflictAbort(tx, CONFLICT_KILLED, NULL);
 	}
 
 	tx->writes.writeback();
@@ -151,7 +153,7 @@ namespace {
     BytePrio::read_rw(STM_READ_SIG(tx,addr,mask))
     {
 	if(tx->alive == ABORTED){
-	    tx->tmabort(tx);
+	    ConflictAbort(tx, CONFLICT_KILLED, NULL, addr);
 	}
       
 	uint32_t tries = 0;
@@ -187,7 +189,7 @@ namespace {
 		if (++tries > READ_TIMEOUT){
 		    //writer has higher priority, I'll abort
 		    if(owner > MK_LOCK_VAL(tx->id, tx->prio)){
-			tx->tmabort(tx);
+			ConflictAbort(tx, CONFLICT_LOCKED, lock, addr);
 		    }
 		    //I have higher priority, so force the writer to abort
 		    if(!bcas32(&(stm::threads[GET_WR_ID(owner)-1]->alive), RUNNING, ABORTED)){
@@ -218,7 +220,8 @@ namespace {
     BytePrio::write_rw(STM_WRITE_SIG(tx,addr,val,mask))
     {
 	if(tx->alive == ABORTED){
-	    tx->tmabort(tx);  //someone aborted us
+	    //someone aborted us
+	    ConflictAbort(tx, CONFLICT_KILLED, NULL, addr);
 	}
 	
 	uint32_t tries = 0;
@@ -247,7 +250,7 @@ namespace {
 		    //no need to check for readers since we stole this from a writer
 		    return;
 		}
-		tx->tmabort(tx);
+		ConflictAbort(tx, CONFLICT_LOCKED, lock, addr);
 	    }
 	}
 	
@@ -266,7 +269,8 @@ namespace {
 		if (++tries > DRAIN_TIMEOUT){
 		    for(int j = i * 4; j < BYTELOCK_READERS; j++){
 			if(lock->reader[j] > tx->prio){
-			    tx->tmabort(tx);  //a reader has higher priority than me
+			    //a reader has higher priority than me
+			    ConflictAbort(tx, CONFLICT_LOCKED, lock, addr);
 			}
 		    }
 		    //kill all readers
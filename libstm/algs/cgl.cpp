@@ -18,6 +18,7 @@
  *        transaction is read-only or not
  */
 
+#include <cstring>
 #include "../profiling.hpp"
 #include "algs.hpp"
 #include <stm/UndoLog.hpp> // STM_DO_MASKED_WRITE
@@ -40,6 +41,9 @@ namespace
       static TM_FASTCALL void* read(STM_READ_SIG(,,));
       static TM_FASTCALL void write(STM_WRITE_SIG(,,,));
       static TM_FASTCALL void commit(TxThread*);
+      static TM_FASTCALL void read_range(TxThread*, void**, void*, size_t);
+      static TM_FASTCALL void write_range(TxThread*, void**, const void*,
+                                          size_t);
 
       static stm::scope_t* rollback(STM_ROLLBACK_SIG(,,));
       static bool irrevoc(TxThread*);
@@ -75,6 +79,21 @@ namespace
       STM_DO_MASKED_WRITE(addr, val, mask);
   }
 
+  /**
+   *  CGL bulk read and write:
+   */
+  void
+  CGL::read_range(TxThread*, void** addr, void* buf, size_t words)
+  {
+      memcpy(buf, addr, words * sizeof(void*));
+  }
+
+  void
+  CGL::write_range(TxThread*, void** addr, const void* buf, size_t words)
+  {
+      memcpy(addr, buf, words * sizeof(void*));
+  }
+
   /**
    *  CGL unwinder:
    *
@@ -153,6 +172,8 @@ namespace stm {
       stms[CGL].commit    = ::CGL::commit;
       stms[CGL].read      = ::CGL::read;
       stms[CGL].write     = ::CGL::write;
+      stms[CGL].read_range  = ::CGL::read_range;
+      stms[CGL].write_range = ::CGL::write_range;
       stms[CGL].rollback  = ::CGL::rollback;
       stms[CGL].irrevoc   = ::CGL::irrevoc;
       stms[CGL].switcher  = ::CGL::onSwitchTo;
@@ -34,6 +34,7 @@ using stm::UNRECOVERABLE;
 using stm::WriteSetEntry;
 using stm::orec_t;
 using stm::get_orec;
+using stm::CONFLICT_VALIDATION;
 
 
 /**
@@ -144,7 +145,7 @@ namespace {
       // NB: this is a pretty serious tradeoff... it admits false aborts for
       //     the sake of preventing a 'check if locked' test
       if (ivt > tx->ts_cache)
-          tx->tmabort(tx);
+          ConflictAbort(tx, CONFLICT_VALIDATION, o, addr);
 
       // log orec
       tx->r_orecs.insert(o);
@@ -241,7 +242,7 @@ namespace {
           uintptr_t ivt = (*i)->v.all;
           // if it has a timestamp of ts_cache or greater, abort
           if (ivt > tx->ts_cache)
-              tx->tmabort(tx);
+              ConflictAbort(tx, CONFLICT_VALIDATION, *i);
       }
       // now update the finish_cache to remember that at this time, we were
       // still valid
@@ -33,6 +33,7 @@ using stm::UNRECOVERABLE;
 using stm::orec_t;
 using stm::get_orec;
 using stm::WriteSetEntry;
+using stm::CONFLICT_VALIDATION;
 
 
 /**
@@ -108,7 +109,7 @@ namespace {
           uintptr_t ivt = (*i)->v.all;
           // if it has a timestamp of ts_cache or greater, abort
           if (ivt > tx->ts_cache)
-              tx->tmabort(tx);
+              ConflictAbort(tx, CONFLICT_VALIDATION, *i);
       }
       // writeback
       if (tx->writes.size() != 0) {
@@ -165,7 +166,7 @@ namespace {
       uintptr_t ivt = o->v.all;
       // abort if this changed since the last time I saw someone finish
       if (ivt > tx->ts_cache)
-          tx->tmabort(tx);
+          ConflictAbort(tx, CONFLICT_VALIDATION, o, addr);
 
       // log orec
       tx->r_orecs.insert(o);
@@ -178,7 +179,7 @@ namespace {
               uintptr_t ivt_inner = (*i)->v.all;
               // if it has a timestamp of ts_cache or greater, abort
               if (ivt_inner > tx->ts_cache)
-                  tx->tmabort(tx);
+                  ConflictAbort(tx, CONFLICT_VALIDATION, *i);
           }
           // now update the ts_cache to remember that at this time, we were
           // still valid
@@ -207,7 +208,7 @@ namespace {
       uintptr_t ivt = o->v.all;
       // abort if this changed since the last time I saw someone finish
       if (ivt > tx->ts_cache)
-          tx->tmabort(tx);
+          ConflictAbort(tx, CONFLICT_VALIDATION, o, addr);
 
       // log orec
       tx->r_orecs.insert(o);
@@ -319,7 +320,7 @@ namespace {
           uintptr_t ivt = (*i)->v.all;
           // if it has a timestamp of ts_cache or greater, abort
           if (ivt > tx->ts_cache)
-              tx->tmabort(tx);
+              ConflictAbort(tx, CONFLICT_VALIDATION, *i);
       }
       // now update the finish_cache to remember that at this time, we were
       // still valid
@@ -32,6 +32,8 @@ using stm::UNRECOVERABLE;
 using stm::WriteSetEntry;
 using stm::orec_t;
 using stm::get_orec;
+using stm::CONFLICT_LOCKED;
+using stm::CONFLICT_VALIDATION;
 
 
 /**
@@ -97,14 +99,14 @@ namespace {
           if (ivt <= tx->start_time) {
               // abort if cannot acquire
               if (!bcasptr(&o->v.all, ivt, tx->my_lock.all))
-                  tx->tmabort(tx);
+                  ConflictAbort(tx, CONFLICT_LOCKED, o, i->addr);
               // save old version to o->p, remember that we hold the lock
               o->p = ivt;
               tx->locks.insert(o);
           }
           // else if we don't hold the lock abort
           else if (ivt != tx->my_lock.all) {
-              tx->tmabort(tx);
+              ConflictAbort(tx, CONFLICT_LOCKED, o, i->addr);
           }
       }
 
@@ -154,7 +156,7 @@ namespace {
           return tmp;
       }
       // unreachable
-      tx->tmabort(tx);
+      ConflictAbort(tx, CONFLICT_VALIDATION, o, addr);
       return NULL;
   }
 
@@ -187,7 +189,7 @@ namespace {
           tx->r_orecs.insert(o);
           return tmp;
       }
-      tx->tmabort(tx);
+      ConflictAbort(tx, CONFLICT_VALIDATION, o, addr);
       // unreachable
       return NULL;
   }
@@ -257,7 +259,7 @@ namespace {
           uintptr_t ivt = (*i)->v.all;
           // if unlocked and newer than start time, abort
           if ((ivt > tx->start_time) && (ivt != tx->my_lock.all))
-              tx->tmabort(tx);
+              ConflictAbort(tx, CONFLICT_VALIDATION, *i);
       }
   }
 
@@ -35,6 +35,8 @@ using stm::NanorecList;
 using stm::nanorec_t;
 using stm::get_nanorec;
 using stm::id_version_t;
+using stm::CONFLICT_LOCKED;
+using stm::CONFLICT_VALIDATION;
 
 
 /**
@@ -98,13 +100,13 @@ namespace {
           if (ivt.all != tx->my_lock.all) {
               if (!ivt.fields.lock) {
                   if (!bcasptr(&o->v.all, ivt.all, tx->my_lock.all))
-                      tx->tmabort(tx);
+                      ConflictAbort(tx, CONFLICT_LOCKED, o, i->addr);
                   // save old version to o->p, remember that we hold the lock
                   o->p = ivt.all;
                   tx->locks.insert(o);
               }
               else {
-                  tx->tmabort(tx);
+                  ConflictAbort(tx, CONFLICT_LOCKED, o, i->addr);
               }
           }
       }
@@ -115,7 +117,7 @@ namespace {
           // if orec does not match val, then it must be locked by me, with its
           // old val equalling my expected val
           if ((ivt != i->v) && ((ivt != tx->my_lock.all) || (i->v != i->o->p)))
-              tx->tmabort(tx);
+              ConflictAbort(tx, CONFLICT_VALIDATION, i->o);
       }
 
       // run the redo log
@@ -161,7 +163,7 @@ namespace {
               // validate the whole read set, then return the value we just read
               foreach (NanorecList, i, tx->nanorecs)
                   if (i->o->v.all != i->v)
-                      tx->tmabort(tx);
+                      ConflictAbort(tx, CONFLICT_VALIDATION, i->o);
               return tmp;
           }
 
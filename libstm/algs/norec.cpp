@@ -17,6 +17,7 @@
  *    strong as Asymmetric Lock Atomicity (ALA).
  */
 
+#include <cstring>
 #include "../cm.hpp"
 #include "algs.hpp"
 #include "RedoRAWUtils.hpp"
@@ -47,6 +48,8 @@ namespace {
       static TM_FASTCALL void* read_rw(STM_READ_SIG(,,));
       static TM_FASTCALL void write_ro(STM_WRITE_SIG(,,,));
       static TM_FASTCALL void write_rw(STM_WRITE_SIG(,,,));
+      static TM_FASTCALL void read_range(TxThread*, void**, void*, size_t);
+      static TM_FASTCALL void defer(TxThread*);
       static stm::scope_t* rollback(STM_ROLLBACK_SIG(,,));
       static void initialize(int id, const char* name);
   };
@@ -68,8 +71,10 @@ namespace {
           foreach (ValueList, i, tx->vlist)
               valid &= STM_LOG_VALUE_IS_VALID(i, tx);
 
-          if (!valid)
+          if (!valid) {
+              NoteValueConflict(tx);
               return VALIDATION_FAILED;
+          }
 
           // restart if timestamp changed during read set iteration
           CFENCE;
@@ -118,8 +123,12 @@ namespace {
       stm::stms[id].commit    = NOrec_Generic<CM>::commit_ro;
       stm::stms[id].read      = NOrec_Generic<CM>::read_ro;
       stm::stms[id].write     = NOrec_Generic<CM>::write_ro;
+      stm::stms[id].read_range = NOrec_Generic<CM>::read_range;
+      stm::stms[id].defer      = NOrec_Generic<CM>::defer;
       stm::stms[id].irrevoc   = irrevoc;
       stm::stms[id].switcher  = onSwitchTo;
+      stm::stms[id].family    =
+          stm::SwitchableCM<CM>::value ? stm::SeqlockFamily : stm::NoFamily;
       stm::stms[id].privatization_safe = true;
       stm::stms[id].rollback  = NOrec_Generic<CM>::rollback;
   }
@@ -179,6 +188,14 @@ namespace {
   void
   NOrec_Generic<CM>::commit_ro(TxThread* tx)
   {
+#ifdef STM_STATIC_DISPATCH_NOrec
+      // the program's write barrier can't switch us to commit_rw (see
+      // static_dispatch.hpp)
+      if (tx->writes.size()) {
+          commit_rw(tx);
+          return;
+      }
+#endif
       // Since all reads were consistent, and no writes were done, the read-only
       // NOrec transaction just resets itself and is done.
       CM::onCommit(tx);
@@ -199,6 +216,7 @@ namespace {
               tx->tmabort(tx);
 
       tx->writes.writeback();
+      WritebackDeferred(tx);
 
       // Release the sequence lock, then clean up
       CFENCE;
@@ -241,6 +259,34 @@ namespace {
       return tmp;
   }
 
+  /**
+   *  NOrec bulk read (read-only context):
+   *
+   *    Like read_ro, but the whole range is copied between two checks of
+   *    the sequence lock, rather than one word at a time
+   */
+  template <class CM>
+  void
+  NOrec_Generic<CM>::read_range(TxThread* tx, void** addr, void* buf,
+                                size_t words)
+  {
+      memcpy(buf, addr, words * sizeof(void*));
+      CFENCE;
+      while (tx->start_time != timestamp.val) {
+          if ((tx->start_time = validate(tx)) == VALIDATION_FAILED)
+              tx->tmabort(tx);
+          memcpy(buf, addr, words * sizeof(void*));
+          CFENCE;
+      }
+
+      // log what we read, so that commit-time validation can check it
+      for (size_t i = 0; i < words; ++i) {
+          void* val;
+          memcpy(&val, (char*)buf + i * sizeof(void*), sizeof(void*));
+          STM_LOG_VALUE(tx, addr + i, val, ~0x0);
+      }
+  }
+
   template <class CM>
   void*
   NOrec_Generic<CM>::read_rw(STM_READ_SIG(tx,addr,mask))
@@ -271,6 +317,19 @@ namespace {
       OnFirstWrite(tx, read_rw, write_rw, commit_rw);
   }
 
+  /**
+   *  NOrec commutative updates:
+   *
+   *    commit_rw does them while it holds the sequence lock, even if the
+   *    write set is empty
+   */
+  template <class CM>
+  void
+  NOrec_Generic<CM>::defer(TxThread* tx)
+  {
+      OnFirstWrite(tx, read_rw, write_rw, commit_rw);
+  }
+
   template <class CM>
   void
   NOrec_Generic<CM>::write_rw(STM_WRITE_SIG(tx,addr,val,mask))
@@ -315,6 +374,20 @@ namespace {
 
 namespace stm {
   FOREACH_NOREC(INIT_NOREC)
+
+#ifdef STM_STATIC_DISPATCH_NOrec
+  /*** the slow paths of the static-dispatch barriers (static_dispatch.hpp) */
+  void norec_revalidate(TxThread* tx)
+  {
+      if ((tx->start_time = validate(tx)) == VALIDATION_FAILED)
+          tx->tmabort(tx);
+  }
+
+  void* norec_read_rw(STM_READ_SIG(tx,addr,mask))
+  {
+      return NOrec_Generic<HyperAggressiveCM>::read_rw(tx, addr STM_MASK(mask));
+  }
+#endif
 }
 
 #undef FOREACH_NOREC
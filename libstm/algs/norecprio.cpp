@@ -274,8 +274,10 @@ namespace {
           foreach (ValueList, i, tx->vlist)
               valid &= STM_LOG_VALUE_IS_VALID(i, tx);
 
-          if (!valid)
+          if (!valid) {
+              NoteValueConflict(tx);
               return VALIDATION_FAILED;
+          }
 
           // restart if timestamp changed during read set iteration
           CFENCE;
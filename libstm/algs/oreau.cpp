@@ -32,6 +32,9 @@ using stm::get_orec;
 using stm::id_version_t;
 using stm::threads;
 using stm::UndoLogEntry;
+using stm::CONFLICT_KILLED;
+using stm::CONFLICT_LOCKED;
+using stm::CONFLICT_VALIDATION;
 
 
 /**
@@ -122,7 +125,7 @@ namespace {
               uintptr_t ivt = (*i)->v.all;
               // if unlocked and newer than start time, abort
               if ((ivt > tx->start_time) && (ivt != tx->my_lock.all))
-                  tx->tmabort(tx);
+                  ConflictAbort(tx, CONFLICT_VALIDATION, *i);
           }
       }
 
@@ -173,12 +176,12 @@ namespace {
               if (CM::mayKill(tx, ivt.fields.id - 1))
                   threads[ivt.fields.id-1]->alive = TX_ABORTED;
               else
-                  tx->tmabort(tx);
+                  ConflictAbort(tx, CONFLICT_LOCKED, o, addr);
           }
 
           // liveness check
           if (tx->alive == TX_ABORTED)
-              tx->tmabort(tx);
+              ConflictAbort(tx, CONFLICT_KILLED, NULL, addr);
 
           // scale timestamp if ivt2 is too new
           uintptr_t newts = timestamp.val;
@@ -224,12 +227,12 @@ namespace {
               if (CM::mayKill(tx, ivt.fields.id - 1))
                   threads[ivt.fields.id-1]->alive = TX_ABORTED;
               else
-                  tx->tmabort(tx);
+                  ConflictAbort(tx, CONFLICT_LOCKED, o, addr);
           }
 
           // liveness check
           if (tx->alive == TX_ABORTED)
-              tx->tmabort(tx);
+              ConflictAbort(tx, CONFLICT_KILLED, NULL, addr);
 
           // scale timestamp if ivt2 is too new
           uintptr_t newts = timestamp.val;
@@ -256,7 +259,7 @@ namespace {
           // common case: uncontended location... lock it
           if (ivt.all <= tx->start_time) {
               if (!bcasptr(&o->v.all, ivt.all, tx->my_lock.all))
-                  tx->tmabort(tx);
+                  ConflictAbort(tx, CONFLICT_LOCKED, o, addr);
 
               // save old, log lock, write, return
               o->p = ivt.all;
@@ -272,12 +275,12 @@ namespace {
               if (CM::mayKill(tx, ivt.fields.id - 1))
                   threads[ivt.fields.id-1]->alive = TX_ABORTED;
               else
-                  tx->tmabort(tx);
+                  ConflictAbort(tx, CONFLICT_LOCKED, o, addr);
           }
 
           // liveness check
           if (tx->alive == TX_ABORTED)
-              tx->tmabort(tx);
+              ConflictAbort(tx, CONFLICT_KILLED, NULL, addr);
 
           // unlocked but too new... scale forward and try again
           uintptr_t newts = timestamp.val;
@@ -303,7 +306,7 @@ namespace {
           // common case: uncontended location... lock it
           if (ivt.all <= tx->start_time) {
               if (!bcasptr(&o->v.all, ivt.all, tx->my_lock.all))
-                  tx->tmabort(tx);
+                  ConflictAbort(tx, CONFLICT_LOCKED, o, addr);
 
               // save old, log lock, write, return
               o->p = ivt.all;
@@ -325,12 +328,12 @@ namespace {
               if (CM::mayKill(tx, ivt.fields.id - 1))
                   threads[ivt.fields.id-1]->alive = TX_ABORTED;
               else
-                  tx->tmabort(tx);
+                  ConflictAbort(tx, CONFLICT_LOCKED, o, addr);
           }
 
           // liveness check
           if (tx->alive == TX_ABORTED)
-              tx->tmabort(tx);
+              ConflictAbort(tx, CONFLICT_KILLED, NULL, addr);
 
           // unlocked but too new... scale forward and try again
           uintptr_t newts = timestamp.val;
@@ -404,7 +407,7 @@ namespace {
           uintptr_t ivt = (*i)->v.all;
           // if unlocked and newer than start time, abort
           if ((ivt > tx->start_time) && (ivt != tx->my_lock.all))
-              tx->tmabort(tx);
+              ConflictAbort(tx, CONFLICT_VALIDATION, *i);
       }
   }
 
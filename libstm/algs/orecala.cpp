@@ -32,6 +32,8 @@ using stm::orec_t;
 using stm::get_orec;
 using stm::WriteSetEntry;
 using stm::UNRECOVERABLE;
+using stm::CONFLICT_LOCKED;
+using stm::CONFLICT_VALIDATION;
 
 
 /**
@@ -114,13 +116,13 @@ namespace {
           if (ivt <= tx->start_time) {
               // abort if cannot acquire
               if (!bcasptr(&o->v.all, ivt, tx->my_lock.all))
-                  tx->tmabort(tx);
+                  ConflictAbort(tx, CONFLICT_LOCKED, o, i->addr);
               // save old version to o->p, remember that we hold the lock
               o->p = ivt;
               tx->locks.insert(o);
           }
           else if (ivt != tx->my_lock.all) {
-              tx->tmabort(tx);
+              ConflictAbort(tx, CONFLICT_LOCKED, o, i->addr);
           }
       }
 
@@ -133,7 +135,7 @@ namespace {
               // read this orec
               uintptr_t ivt = (*i)->v.all;
               if ((ivt > tx->start_time) && (ivt != tx->my_lock.all))
-                  tx->tmabort(tx);
+                  ConflictAbort(tx, CONFLICT_VALIDATION, *i);
           }
       }
 
@@ -176,7 +178,7 @@ namespace {
 
       // make sure this location isn't locked or too new
       if (o->v.all > tx->start_time)
-          tx->tmabort(tx);
+          ConflictAbort(tx, CONFLICT_VALIDATION, o, addr);
 
       // privatization safety: poll the timestamp, maybe validate
       uintptr_t ts = timestamp.val;
@@ -291,7 +293,7 @@ namespace {
           // if orec unlocked and newer than start time, it changed, so abort.
           // if locked, it's not locked by me so abort
           if ((*i)->v.all > tx->start_time)
-              tx->tmabort(tx);
+              ConflictAbort(tx, CONFLICT_VALIDATION, *i);
       }
 
       // remember that we validated at this time
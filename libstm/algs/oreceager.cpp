@@ -52,6 +52,8 @@ using stm::orec_t;
 using stm::get_orec;
 using stm::id_version_t;
 using stm::UndoLogEntry;
+using stm::CONFLICT_LOCKED;
+using stm::CONFLICT_VALIDATION;
 
 
 /**
@@ -97,6 +99,8 @@ namespace {
       stm::stms[id].write     = write;
       stm::stms[id].irrevoc   = irrevoc;
       stm::stms[id].switcher  = onSwitchTo;
+      stm::stms[id].family    =
+          stm::SwitchableCM<CM>::value ? stm::OrecFamily : stm::NoFamily;
       stm::stms[id].privatization_safe = false;
   }
 
@@ -140,7 +144,7 @@ namespace {
               // abort unless orec older than start or owned by me
               uintptr_t ivt = (*i)->v.all;
               if ((ivt > tx->start_time) && (ivt != tx->my_lock.all))
-                  tx->tmabort(tx);
+                  ConflictAbort(tx, CONFLICT_VALIDATION, *i);
           }
       }
 
@@ -194,7 +198,7 @@ namespace {
 
           // abort if locked
           if (__builtin_expect(ivt.fields.lock, 0))
-              tx->tmabort(tx);
+              ConflictAbort(tx, CONFLICT_LOCKED, o, addr);
 
           // scale timestamp if ivt is too new, then try again
           uintptr_t newts = timestamp.val;
@@ -221,7 +225,7 @@ namespace {
           // common case: uncontended location... try to lock it, abort on fail
           if (ivt.all <= tx->start_time) {
               if (!bcasptr(&o->v.all, ivt.all, tx->my_lock.all))
-                  tx->tmabort(tx);
+                  ConflictAbort(tx, CONFLICT_LOCKED, o, addr);
 
               // save old value, log lock, do the write, and return
               o->p = ivt.all;
@@ -242,7 +246,7 @@ namespace {
 
           // fail if lock held by someone else
           if (ivt.fields.lock)
-              tx->tmabort(tx);
+              ConflictAbort(tx, CONFLICT_LOCKED, o, addr);
 
           // unlocked but too new... scale forward and try again
           uintptr_t newts = timestamp.val;
@@ -348,7 +352,7 @@ namespace {
           uintptr_t ivt = (*i)->v.all;
           // if unlocked and newer than start time, abort
           if ((ivt > tx->start_time) && (ivt != tx->my_lock.all))
-              tx->tmabort(tx);
+              ConflictAbort(tx, CONFLICT_VALIDATION, *i);
       }
   }
 
@@ -31,6 +31,8 @@ using stm::WriteSetEntry;
 using stm::timestamp;
 using stm::timestamp_max;
 using stm::id_version_t;
+using stm::CONFLICT_LOCKED;
+using stm::CONFLICT_VALIDATION;
 
 
 /**
@@ -98,7 +100,7 @@ namespace {
           uintptr_t ivt = (*i)->v.all;
           // if unlocked and newer than start time, abort
           if ((ivt > tx->start_time) && (ivt != tx->my_lock.all))
-              tx->tmabort(tx);
+              ConflictAbort(tx, CONFLICT_VALIDATION, *i);
       }
 
       // run the redo log
@@ -145,7 +147,7 @@ namespace {
 
           // abort if locked by other
           if (ivt.fields.lock)
-              tx->tmabort(tx);
+              ConflictAbort(tx, CONFLICT_LOCKED, o, addr);
 
           // scale timestamp if ivt is too new
           uintptr_t newts = timestamp.val;
@@ -190,7 +192,7 @@ namespace {
 
           // abort if locked by other
           if (ivt.fields.lock)
-              tx->tmabort(tx);
+              ConflictAbort(tx, CONFLICT_LOCKED, o, addr);
 
           // scale timestamp if ivt is too new
           uintptr_t newts = timestamp.val;
@@ -222,7 +224,7 @@ namespace {
           // common case: uncontended location... lock it
           if (ivt.all <= tx->start_time) {
               if (!bcasptr(&o->v.all, ivt.all, tx->my_lock.all))
-                  tx->tmabort(tx);
+                  ConflictAbort(tx, CONFLICT_LOCKED, o, addr);
 
               // save old, log lock, write, return
               o->p = ivt.all;
@@ -233,7 +235,7 @@ namespace {
 
           // fail if lock held
           if (ivt.fields.lock)
-              tx->tmabort(tx);
+              ConflictAbort(tx, CONFLICT_LOCKED, o, addr);
 
           // unlocked but too new... scale forward and try again
           uintptr_t newts = timestamp.val;
@@ -264,7 +266,7 @@ namespace {
           // common case: uncontended location... lock it
           if (ivt.all <= tx->start_time) {
               if (!bcasptr(&o->v.all, ivt.all, tx->my_lock.all))
-                  tx->tmabort(tx);
+                  ConflictAbort(tx, CONFLICT_LOCKED, o, addr);
 
               // save old, log lock, write, return
               o->p = ivt.all;
@@ -278,7 +280,7 @@ namespace {
 
           // fail if lock held
           if (ivt.fields.lock)
-              tx->tmabort(tx);
+              ConflictAbort(tx, CONFLICT_LOCKED, o, addr);
 
           // unlocked but too new... scale forward and try again
           uintptr_t newts = timestamp.val;
@@ -336,7 +338,7 @@ namespace {
           uintptr_t ivt = (*i)->v.all;
           // if unlocked and newer than start time, abort
           if ((ivt > tx->start_time) && (ivt != tx->my_lock.all))
-              tx->tmabort(tx);
+              ConflictAbort(tx, CONFLICT_VALIDATION, *i);
       }
   }
 
@@ -33,6 +33,8 @@ using stm::WriteSet;
 using stm::OrecList;
 using stm::WriteSetEntry;
 using stm::id_version_t;
+using stm::CONFLICT_LOCKED;
+using stm::CONFLICT_VALIDATION;
 
 
 /**
@@ -111,14 +113,14 @@ namespace {
           if (ivt <= tx->start_time) {
               // abort if cannot acquire
               if (!bcasptr(&o->v.all, ivt, tx->my_lock.all))
-                  tx->tmabort(tx);
+                  ConflictAbort(tx, CONFLICT_LOCKED, o, i->addr);
               // save old version to o->p, log lock
               o->p = ivt;
               tx->locks.insert(o);
           }
           // else if we don't hold the lock abort
           else if (ivt != tx->my_lock.all) {
-              tx->tmabort(tx);
+              ConflictAbort(tx, CONFLICT_LOCKED, o, i->addr);
           }
       }
 
@@ -131,7 +133,7 @@ namespace {
               // read this orec
               uintptr_t ivt = (*i)->v.all;
               if ((ivt > tx->start_time) && (ivt != tx->my_lock.all))
-                  tx->tmabort(tx);
+                  ConflictAbort(tx, CONFLICT_VALIDATION, *i);
           }
       }
 
@@ -200,7 +202,7 @@ namespace {
           foreach (OrecList, i, tx->r_orecs) {
               // if orec locked or newer than start time, abort
               if ((*i)->v.all > tx->start_time)
-                  tx->tmabort(tx);
+                  ConflictAbort(tx, CONFLICT_VALIDATION, *i);
           }
 
           uintptr_t cs = last_complete.val;
@@ -313,7 +315,7 @@ namespace {
       foreach (OrecList, i, tx->r_orecs) {
           // if orec locked or newer than start time, abort
           if ((*i)->v.all > tx->start_time)
-              tx->tmabort(tx);
+              ConflictAbort(tx, CONFLICT_VALIDATION, *i);
       }
       // careful here: we can't scale the start time past last_complete.val,
       // unless we want to re-introduce the need for prevalidation on every
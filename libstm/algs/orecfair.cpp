@@ -44,6 +44,8 @@ using stm::MAX_THREADS;
 using stm::threads;
 using stm::prioTxCount;
 using stm::WriteSetEntry;
+using stm::CONFLICT_LOCKED;
+using stm::CONFLICT_VALIDATION;
 
 
 /**
@@ -149,7 +151,7 @@ namespace
 	    // else if we don't hold the lock abort
 	    else if (ivt.all != tx->my_lock.all) {
 		if (!ivt.fields.lock)
-		    tx->tmabort(tx);
+		    ConflictAbort(tx, CONFLICT_VALIDATION, o, i->addr);
 		// priority test... if I have priority, and the last unlocked
 		// version of the orec was the one I read, and the current
 		// owner has less priority than me, wait
@@ -159,7 +161,7 @@ namespace
 			continue;
 		    }
 		}
-		tx->tmabort(tx);
+		ConflictAbort(tx, CONFLICT_LOCKED, o, i->addr);
 	    }
 	    ++i;
 	}
@@ -181,7 +183,7 @@ namespace
 		unsigned mask = 1lu<<(slot % rrec_t::BITS);
 		if (accumulator.bits[bucket] & mask) {
 		    if (threads[slot]->prio > tx->prio)
-			tx->tmabort(tx);
+			ConflictAbort(tx, CONFLICT_LOCKED, NULL);
 		}
 	    }
 	}
@@ -502,7 +504,7 @@ namespace
 	    // only a problem if locked or newer than start time
 	    if (ivt.all > tx->start_time) {
 		if (!ivt.fields.lock)
-		    tx->tmabort(tx);
+		    ConflictAbort(tx, CONFLICT_VALIDATION, *i);
 		// priority test... if I have priority, and the last unlocked
 		// orec was the one I read, and the current owner has less
 		// priority than me, wait
@@ -512,7 +514,7 @@ namespace
 			continue;
 		    }
 		}
-		tx->tmabort(tx);
+		ConflictAbort(tx, CONFLICT_LOCKED, *i);
 	    }
 	    ++i;
 	}
@@ -535,7 +537,7 @@ namespace
 		ivt.all = (*i)->v.all;
 		// if unlocked and newer than start time, abort
 		if (!ivt.fields.lock && (ivt.all > tx->start_time))
-		    tx->tmabort(tx);
+		    ConflictAbort(tx, CONFLICT_VALIDATION, *i);
 
 		// if locked and not by me, do a priority test
 		if (ivt.fields.lock && (ivt.all != tx->my_lock.all)) {
@@ -548,7 +550,7 @@ namespace
 			    spin64();
 			    continue;
 			}
-		    tx->tmabort(tx);
+		    ConflictAbort(tx, CONFLICT_LOCKED, *i);
 		}
 		++i;
 	    }
@@ -560,7 +562,7 @@ namespace
 		ivt.all = (*i)->v.all;
 		// if unlocked and newer than start time, abort
 		if ((ivt.all > tx->start_time) && (ivt.all != tx->my_lock.all))
-		    tx->tmabort(tx);
+		    ConflictAbort(tx, CONFLICT_VALIDATION, *i);
 	    }
 	}
     }
@@ -32,6 +32,8 @@ using stm::orec_t;
 using stm::timestamp;
 using stm::timestamp_max;
 using stm::id_version_t;
+using stm::CONFLICT_LOCKED;
+using stm::CONFLICT_VALIDATION;
 
 
 namespace {
@@ -43,6 +45,7 @@ namespace {
       static TM_FASTCALL void* read_rw(STM_READ_SIG(,,));
       static TM_FASTCALL void write_ro(STM_WRITE_SIG(,,,));
       static TM_FASTCALL void write_rw(STM_WRITE_SIG(,,,));
+      static TM_FASTCALL void defer(TxThread*);
       static TM_FASTCALL void commit_ro(TxThread*);
       static TM_FASTCALL void commit_rw(TxThread*);
 
@@ -66,9 +69,12 @@ namespace {
       stm::stms[id].commit    = OrecLazy_Generic<CM>::commit_ro;
       stm::stms[id].read      = OrecLazy_Generic<CM>::read_ro;
       stm::stms[id].write     = OrecLazy_Generic<CM>::write_ro;
+      stm::stms[id].defer     = OrecLazy_Generic<CM>::defer;
       stm::stms[id].rollback  = OrecLazy_Generic<CM>::rollback;
       stm::stms[id].irrevoc   = irrevoc;
       stm::stms[id].switcher  = onSwitchTo;
+      stm::stms[id].family    =
+          stm::SwitchableCM<CM>::value ? stm::OrecFamily : stm::NoFamily;
       stm::stms[id].privatization_safe = false;
   }
 
@@ -123,27 +129,32 @@ namespace {
           if (ivt <= tx->start_time) {
               // abort if cannot acquire
               if (!bcasptr(&o->v.all, ivt, tx->my_lock.all))
-                  tx->tmabort(tx);
+                  ConflictAbort(tx, CONFLICT_LOCKED, o, i->addr);
               // save old version to o->p, remember that we hold the lock
               o->p = ivt;
               tx->locks.insert(o);
           }
           // else if we don't hold the lock abort
           else if (ivt != tx->my_lock.all) {
-              tx->tmabort(tx);
+              ConflictAbort(tx, CONFLICT_LOCKED, o, i->addr);
           }
       }
+      AcquireDeferred(tx);
 
-      // validate
+      // validate.  If we hold the lock, the version we replaced must not be
+      // newer than start time either, which only matters for orecs that
+      // AcquireDeferred took
       foreach (OrecList, i, tx->r_orecs) {
           uintptr_t ivt = (*i)->v.all;
           // if unlocked and newer than start time, abort
-          if ((ivt > tx->start_time) && (ivt != tx->my_lock.all))
-              tx->tmabort(tx);
+          if ((ivt > tx->start_time) &&
+              ((ivt != tx->my_lock.all) || ((*i)->p > tx->start_time)))
+              ConflictAbort(tx, CONFLICT_VALIDATION, *i);
       }
 
       // run the redo log
       tx->writes.writeback();
+      WritebackDeferred(tx);
 
       // increment the global timestamp, release locks
       uintptr_t end_time = 1 + faiptr(&timestamp.val);
@@ -247,6 +258,19 @@ namespace {
       tx->writes.insert(WriteSetEntry(STM_WRITE_SET_ENTRY(addr, val, mask)));
   }
 
+  /**
+   *  OrecLazy commutative updates:
+   *
+   *    commit_rw locks their orecs and does them, even if the write set is
+   *    empty
+   */
+  template <class CM>
+  void
+  OrecLazy_Generic<CM>::defer(TxThread* tx)
+  {
+      OnFirstWrite(tx, read_rw, write_rw, commit_rw);
+  }
+
   /**
    *  OrecLazy rollback:
    *
@@ -306,7 +330,7 @@ namespace {
       foreach (OrecList, i, tx->r_orecs)
           // abort if orec locked, or if unlocked but timestamp too new
           if ((*i)->v.all > tx->start_time)
-              tx->tmabort(tx);
+              ConflictAbort(tx, CONFLICT_VALIDATION, *i);
   }
 
   /**
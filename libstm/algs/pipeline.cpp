@@ -39,6 +39,7 @@ using stm::OrecList;
 using stm::WriteSet;
 using stm::UNRECOVERABLE;
 using stm::WriteSetEntry;
+using stm::CONFLICT_VALIDATION;
 
 
 /**
@@ -115,7 +116,7 @@ namespace {
           uintptr_t ivt = (*i)->v.all;
           // if it has a timestamp of ts_cache or greater, abort
           if (ivt > tx->ts_cache)
-              tx->tmabort(tx);
+              ConflictAbort(tx, CONFLICT_VALIDATION, *i);
       }
       // mark self as complete
       last_complete.val = tx->order;
@@ -149,7 +150,7 @@ namespace {
           uintptr_t ivt = (*i)->v.all;
           // if it has a timestamp of ts_cache or greater, abort
           if (ivt > tx->ts_cache)
-              tx->tmabort(tx);
+              ConflictAbort(tx, CONFLICT_VALIDATION, *i);
       }
       // mark every location in the write set, and perform write-back
       // NB: we cannot abort anymore
@@ -215,7 +216,7 @@ namespace {
       uintptr_t ivt = o->v.all;
       // abort if this changed since the last time I saw someone finish
       if (ivt > tx->ts_cache)
-          tx->tmabort(tx);
+          ConflictAbort(tx, CONFLICT_VALIDATION, o, addr);
       // log orec
       tx->r_orecs.insert(o);
       // validate if necessary
@@ -243,7 +244,7 @@ namespace {
       uintptr_t ivt = o->v.all;
       // abort if this changed since the last time I saw someone finish
       if (ivt > tx->ts_cache)
-          tx->tmabort(tx);
+          ConflictAbort(tx, CONFLICT_VALIDATION, o, addr);
       // log orec
       tx->r_orecs.insert(o);
       // validate if necessary
@@ -352,7 +353,7 @@ namespace {
           uintptr_t ivt = (*i)->v.all;
           // if it has a timestamp of ts_cache or greater, abort
           if (ivt > tx->ts_cache)
-              tx->tmabort(tx);
+              ConflictAbort(tx, CONFLICT_VALIDATION, *i);
       }
       // now update the finish_cache to remember that at this time, we were
       // still valid
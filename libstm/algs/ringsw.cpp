@@ -28,6 +28,8 @@ using stm::last_init;
 using stm::ring_wf;
 using stm::RING_ELEMENTS;
 using stm::WriteSetEntry;
+using stm::CONFLICT_RING;
+using stm::CONFLICT_VALIDATION;
 
 
 /**
@@ -103,7 +105,7 @@ namespace {
               // intersect against all new entries
               for (uintptr_t i = commit_time; i >= tx->start_time + 1; i--)
                   if (ring_wf[i % RING_ELEMENTS].intersect(tx->rf))
-                      tx->tmabort(tx);
+                      ConflictAbort(tx, CONFLICT_VALIDATION, NULL);
 
               // wait for newest entry to be wb-complete before continuing
               while (last_complete.val < commit_time)
@@ -111,7 +113,7 @@ namespace {
 
               // detect ring rollover: start.ts must not have changed
               if (timestamp.val > (tx->start_time + RING_ELEMENTS))
-                  tx->tmabort(tx);
+                  ConflictAbort(tx, CONFLICT_RING, NULL);
 
               // ensure this tx doesn't look at this entry again
               tx->start_time = commit_time;
@@ -233,7 +235,7 @@ namespace {
       // intersect against all new entries
       for (uintptr_t i = my_index; i >= tx->start_time + 1; i--)
           if (ring_wf[i % RING_ELEMENTS].intersect(tx->rf))
-              tx->tmabort(tx);
+              ConflictAbort(tx, CONFLICT_VALIDATION, NULL);
 
       // wait for newest entry to be writeback-complete before returning
       while (last_complete.val < my_index)
@@ -241,7 +243,7 @@ namespace {
 
       // detect ring rollover: start.ts must not have changed
       if (timestamp.val > (tx->start_time + RING_ELEMENTS))
-          tx->tmabort(tx);
+          ConflictAbort(tx, CONFLICT_RING, NULL);
 
       // ensure this tx doesn't look at this entry again
       tx->start_time = my_index;
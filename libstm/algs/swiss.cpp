@@ -30,6 +30,9 @@ using stm::id_version_t;
 using stm::nanorec_t;
 using stm::NanorecList;
 using stm::OrecList;
+using stm::CONFLICT_KILLED;
+using stm::CONFLICT_LOCKED;
+using stm::CONFLICT_VALIDATION;
 
 
 /**
@@ -130,7 +133,7 @@ namespace
               // bad read: we'll go back to top, but first make sure we didn't
               // get aborted
               if (tx->alive == ABORTED)
-                  tx->tmabort(tx);
+                  ConflictAbort(tx, CONFLICT_KILLED, NULL, addr);
               continue;
           }
           // the read was good: log the orec
@@ -169,10 +172,10 @@ namespace
           // if locked, CM will either tell us to self-abort, or to continue
           if (ivt.fields.lock) {
               if (cm_should_abort(tx, ivt.fields.id))
-                  tx->tmabort(tx);
+                  ConflictAbort(tx, CONFLICT_LOCKED, o, addr);
               // check liveness before continuing
               if (tx->alive == ABORTED)
-                  tx->tmabort(tx);
+                  ConflictAbort(tx, CONFLICT_KILLED, NULL, addr);
               continue;
           }
 
@@ -180,7 +183,7 @@ namespace
           if (!bcasptr(&o->v.all, ivt.all, tx->my_lock.all)) {
               // check liveness before continuing
               if (tx->alive == ABORTED)
-                  tx->tmabort(tx);
+                  ConflictAbort(tx, CONFLICT_KILLED, NULL, addr);
               continue;
           }
 
@@ -284,7 +287,7 @@ namespace
   {
       foreach (OrecList, i, tx->r_orecs) {
           if ((*i)->p > tx->start_time)
-              tx->tmabort(tx);
+              ConflictAbort(tx, CONFLICT_VALIDATION, *i);
       }
   }
 
@@ -300,7 +303,7 @@ namespace
                   foreach (NanorecList, i, tx->nanorecs) {
                       i->o->p = i->v;
                   }
-                  tx->tmabort(tx);
+                  ConflictAbort(tx, CONFLICT_VALIDATION, *i);
               }
           }
       }
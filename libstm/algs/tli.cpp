@@ -27,6 +27,7 @@ using stm::timestamp;
 using stm::threads;
 using stm::threadcount;
 using stm::WriteSetEntry;
+using stm::CONFLICT_KILLED;
 
 
 /**
@@ -70,7 +71,7 @@ namespace {
   {
       // if the transaction is invalid, abort
       if (__builtin_expect(tx->alive == 2, false))
-          tx->tmabort(tx);
+          ConflictAbort(tx, CONFLICT_KILLED, NULL);
 
       // ok, all is good
       tx->alive = 0;
@@ -86,7 +87,7 @@ namespace {
   {
       // if the transaction is invalid, abort
       if (__builtin_expect(tx->alive == 2, false))
-          tx->tmabort(tx);
+          ConflictAbort(tx, CONFLICT_KILLED, NULL);
 
       // grab the lock to stop the world
       uintptr_t tmp = timestamp.val;
@@ -98,7 +99,7 @@ namespace {
       // double check that we're valid
       if (__builtin_expect(tx->alive == 2,false)) {
           timestamp.val = tmp + 2; // release the lock
-          tx->tmabort(tx);
+          ConflictAbort(tx, CONFLICT_KILLED, NULL);
       }
 
       // kill conflicting transactions
@@ -147,7 +148,7 @@ namespace {
               return val;
           // abort if we're killed
           if (tx->alive == 2)
-              tx->tmabort(tx);
+              ConflictAbort(tx, CONFLICT_KILLED, NULL, addr);
       }
   }
 
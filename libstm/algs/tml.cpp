@@ -19,6 +19,7 @@
  *        probably add ro/rw functions
  */
 
+#include <cstring>
 #include "../profiling.hpp"
 #include "algs.hpp"
 #include "tml_inline.hpp"
@@ -43,6 +44,11 @@ namespace {
       static TM_FASTCALL void* read(STM_READ_SIG(,,));
       static TM_FASTCALL void write(STM_WRITE_SIG(,,,));
       static TM_FASTCALL void commit(TxThread*);
+      static TM_FASTCALL void* read_ro(STM_READ_SIG(,,));
+      static TM_FASTCALL void commit_ro(TxThread*);
+      static TM_FASTCALL void read_range(TxThread*, void**, void*, size_t);
+      static TM_FASTCALL void write_range(TxThread*, void**, const void*,
+                                          size_t);
 
       static stm::scope_t* rollback(STM_ROLLBACK_SIG(,,));
       static bool irrevoc(TxThread*);
@@ -104,6 +110,53 @@ namespace {
       return val;
   }
 
+  /**
+   *  TML read (declared read-only transactions):
+   *
+   *    We will never hold the lock, so we needn't check for it.
+   */
+  void*
+  TML::read_ro(STM_READ_SIG(tx,addr,))
+  {
+      void* val = *addr;
+      afterread_TML(tx);
+      return val;
+  }
+
+  /**
+   *  TML commit (declared read-only transactions):
+   */
+  void
+  TML::commit_ro(TxThread* tx)
+  {
+      OnReadOnlyCommit(tx);
+      Trigger::onCommitLock(tx);
+  }
+
+  /**
+   *  TML bulk read:
+   *
+   *    The whole range needs only one check of the sequence lock
+   */
+  void
+  TML::read_range(TxThread* tx, void** addr, void* buf, size_t words)
+  {
+      memcpy(buf, addr, words * sizeof(void*));
+      if (!tx->tmlHasLock)
+          afterread_TML(tx);
+  }
+
+  /**
+   *  TML bulk write:
+   */
+  void
+  TML::write_range(TxThread* tx, void** addr, const void* buf, size_t words)
+  {
+      if (!tx->tmlHasLock)
+          beforewrite_TML(tx);
+      memcpy(addr, buf, words * sizeof(void*));
+  }
+
   /**
    *  TML write:
    *
@@ -180,9 +233,14 @@ namespace stm {
       stms[TML].commit    = ::TML::commit;
       stms[TML].read      = ::TML::read;
       stms[TML].write     = ::TML::write;
+      stms[TML].ro_read   = ::TML::read_ro;
+      stms[TML].ro_commit = ::TML::commit_ro;
+      stms[TML].read_range  = ::TML::read_range;
+      stms[TML].write_range = ::TML::write_range;
       stms[TML].rollback  = ::TML::rollback;
       stms[TML].irrevoc   = ::TML::irrevoc;
       stms[TML].switcher  = ::TML::onSwitchTo;
+      stms[TML].family    = SeqlockFamily;
       stms[TML].privatization_safe = true;
   }
 }
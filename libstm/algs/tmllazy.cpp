@@ -25,6 +25,7 @@
 using stm::TxThread;
 using stm::timestamp;
 using stm::WriteSetEntry;
+using stm::CONFLICT_VALIDATION;
 
 /**
  *  Declare the functions that we're going to implement, so that we can avoid
@@ -81,7 +82,7 @@ namespace {
   {
       // we have writes... if we can't get the lock, abort
       if (!bcasptr(&timestamp.val, tx->start_time, tx->start_time + 1))
-          tx->tmabort(tx);
+          ConflictAbort(tx, CONFLICT_VALIDATION, (void*)&timestamp.val);
 
       // we're committed... run the redo log
       tx->writes.writeback();
@@ -107,7 +108,7 @@ namespace {
       // NB: this form of /if/ appears to be faster
       if (__builtin_expect(timestamp.val == tx->start_time, true))
           return tmp;
-      tx->tmabort(tx);
+      ConflictAbort(tx, CONFLICT_VALIDATION, (void*)&timestamp.val, addr);
       // unreachable
       return NULL;
   }
@@ -218,6 +219,7 @@ namespace stm {
       stm::stms[TMLLazy].rollback = ::TMLLazy::rollback;
       stm::stms[TMLLazy].irrevoc  = ::TMLLazy::irrevoc;
       stm::stms[TMLLazy].switcher = ::TMLLazy::onSwitchTo;
+      stm::stms[TMLLazy].family   = stm::SeqlockFamily;
       stm::stms[TMLLazy].privatization_safe = true;
   }
 }
@@ -264,6 +264,21 @@ namespace stm
       static bool mayKill(TxThread*, uint32_t) { return true; }
   };
 
+  /**
+   *  The hourglass CMs hold a global token from an abort until the next
+   *  commit, so a thread must not change CMs between those two points.  The
+   *  other CMs keep no state across transactions, so algorithms that use
+   *  them can be switched without draining in-flight transactions.
+   */
+  template <class CM>
+  struct SwitchableCM { static const bool value = true; };
+  template <>
+  struct SwitchableCM<HourglassCM> { static const bool value = false; };
+  template <>
+  struct SwitchableCM<StrongHourglassCM> { static const bool value = false; };
+  template <>
+  struct SwitchableCM<HourglassBackoffCM> { static const bool value = false; };
+
 }
 
 #endif // CM_HPP__
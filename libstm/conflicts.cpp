@@ -0,0 +1,161 @@
+/**
+ *  Copyright (C) 2011
+ *  University of Rochester Department of Computer Science
+ *    and
+ *  Lehigh University Department of Computer Science and Engineering
+ *
+ * License: Modified BSD
+ *          Please see the file LICENSE.RSTM for licensing information
+ */
+
+/**
+ *  This file implements the abort hotspot report.
+ *
+ *  Before an algorithm aborts a transaction because of a conflict, it notes
+ *  the kind of conflict and the orec, lock, or address involved (see
+ *  ConflictAbort in algs.hpp).  The rollback code then logs the note, along
+ *  with the atomic block that aborted, in the thread's conflict_log_t.
+ *
+ *  The report merges all of the threads' logs, and lists the orecs/locks/
+ *  addresses and the atomic blocks that appear most often.  Since the logs
+ *  only keep each thread's most recent aborts, this describes the recent
+ *  behavior of the program.  The per-kind totals count every abort.
+ *
+ *  An atomic block is printed as the address of its site_t, which is a
+ *  static variable declared by TM_BEGIN, so 'nm -C' on the program shows
+ *  the function that the block is in (after subtracting the load address,
+ *  for a position-independent program).
+ */
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <stm/lib_globals.hpp>
+#include <stm/txthread.hpp>
+
+namespace
+{
+  using namespace stm;
+
+  /*** how many hotspots to print at shutdown (STM_HOTSPOTS) */
+  uint32_t report_size = 0;
+
+#ifdef STM_CONFLICTS_YES
+  typedef conflict_log_t::entry_t entry_t;
+
+  /*** group log entries by their cause */
+  bool by_cause(const entry_t& a, const entry_t& b)
+  {
+      if (a.kind != b.kind)
+          return a.kind < b.kind;
+      return a.where < b.where;
+  }
+
+  bool by_site(const entry_t& a, const entry_t& b)
+  {
+      return a.site < b.site;
+  }
+
+  /*** a run of equivalent entries in the sorted log */
+  struct hotspot_t
+  {
+      const entry_t* first;
+      uint32_t       count;
+
+      bool operator<(const hotspot_t& o) const { return count > o.count; }
+  };
+
+  /**
+   *  Sort the entries with the given ordering, and return the 'top' largest
+   *  runs of equivalent entries in 'spots'
+   */
+  uint32_t rank(entry_t* log, uint32_t size,
+                bool (*less)(const entry_t&, const entry_t&),
+                hotspot_t* spots, uint32_t top)
+  {
+      std::sort(log, log + size, less);
+      uint32_t runs = 0;
+      for (uint32_t i = 0; i < size; ) {
+          uint32_t j = i + 1;
+          while (j < size && !less(log[i], log[j]))
+              ++j;
+          spots[runs].first = &log[i];
+          spots[runs].count = j - i;
+          ++runs;
+          i = j;
+      }
+      top = (top < runs) ? top : runs;
+      std::partial_sort(spots, spots + top, spots + runs);
+      return top;
+  }
+#endif
+} // (anonymous namespace)
+
+namespace stm
+{
+  void conflicts_init()
+  {
+      if (const char* s = getenv("STM_HOTSPOTS"))
+          report_size = strtol(s, 0, 10);
+  }
+
+  void dump_hotspots(uint32_t top)
+  {
+#ifdef STM_CONFLICTS_YES
+      // copy the logs; they may change as we read them, but they are only
+      // approximate anyway
+      uint32_t nthreads = threadcount.val;
+      entry_t* log = new entry_t[nthreads * conflict_log_t::SIZE];
+      hotspot_t* spots = new hotspot_t[nthreads * conflict_log_t::SIZE];
+      uint32_t size = 0;
+      uint64_t totals[CONFLICT_KINDS] = {0};
+      for (uint32_t i = 0; i < nthreads; ++i) {
+          const conflict_log_t& c = threads[i]->conflicts;
+          uint32_t n = c.next;
+          n = (n < conflict_log_t::SIZE) ? n : conflict_log_t::SIZE;
+          for (uint32_t j = 0; j < n; ++j)
+              log[size++] = c.entries[j];
+          for (int k = 0; k < CONFLICT_KINDS; ++k)
+              totals[k] += c.counts[k];
+      }
+
+      std::cout << "Abort causes:";
+      for (int k = 0; k < CONFLICT_KINDS; ++k)
+          std::cout << " " << CONFLICT_NAMES[k] << "=" << totals[k];
+      std::cout << std::endl;
+
+      uint32_t n = rank(log, size, by_cause, spots, top);
+      for (uint32_t i = 0; i < n; ++i) {
+          const entry_t& e = *spots[i].first;
+          std::cout << "Hotspot " << i + 1 << ": " << spots[i].count
+                    << " of " << size << " recent aborts; "
+                    << CONFLICT_NAMES[e.kind];
+          // e.g., remote aborts don't know where the conflict was
+          if (e.where)
+              std::cout << " at " << e.where;
+          if (e.addr)
+              std::cout << " (e.g., address " << e.addr << ")";
+          std::cout << std::endl;
+      }
+
+      n = rank(log, size, by_site, spots, top);
+      for (uint32_t i = 0; i < n; ++i)
+          std::cout << "Aborting site " << i + 1 << ": "
+                    << spots[i].first->site << "; " << spots[i].count
+                    << " of " << size << " recent aborts" << std::endl;
+
+      delete[] spots;
+      delete[] log;
+#else
+      (void)top;
+      std::cout << "Abort hotspots require "
+                << "libstm_enable_conflict_attribution" << std::endl;
+#endif
+  }
+
+  void dump_conflict_stats()
+  {
+      if (report_size)
+          dump_hotspots(report_size);
+  }
+} // namespace stm
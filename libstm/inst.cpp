@@ -13,19 +13,220 @@
  */
 
 #include <sys/mman.h>
+#include <iostream>
+#include <stm/static_dispatch.hpp>
 #include "inst.hpp"
 #include "policies/policies.hpp"
 #include "algs/algs.hpp"
 
+namespace
+{
+  /**
+   *  Counters for reporting the cost of switching.  Every field is written
+   *  only by a thread that has installed begin_blocker, so there are no
+   *  races on them.
+   */
+  struct switch_stats_t
+  {
+      uint64_t blocking;        // number of blocking switches
+      uint64_t blocking_cycles; // switching thread's time in blocking switches
+      uint64_t lazy;            // number of lazy switches
+      uint64_t lazy_cycles;     // switching thread's time in lazy switches
+      uint64_t drained;         // number of lazy switches that fully drained
+      uint64_t drain_cycles;    // time from lazy switch to last thread moving
+      uint64_t drain_max;       // longest such time
+      uint64_t drain_start;     // when the current lazy switch began
+  };
+
+  switch_stats_t switch_stats = {0, 0, 0, 0, 0, 0, 0, 0};
+
+  /**
+   *  Two algorithms can be live at once if they agree on the metadata.  Note
+   *  that switching an algorithm to itself is fine, and is how a policy
+   *  re-selects the current algorithm.
+   */
+  inline bool can_switch_lazily(int old_alg, int new_alg)
+  {
+      return (stm::stms[old_alg].family != stm::NoFamily)
+          && (stm::stms[old_alg].family == stm::stms[new_alg].family);
+  }
+
+  /*** move a thread whose alg_epoch is stale to the current algorithm */
+  inline void catch_up(stm::TxThread* tx)
+  {
+      stm::install_algorithm_local(stm::curr_policy.ALG_ID, tx);
+      tx->consec_aborts = 0;
+      tx->alg_epoch = stm::switch_epoch.val;
+  }
+
+  /**
+   *  A declared read-only transaction wrote after all.  Rather than fail,
+   *  we count it, and upgrade the transaction to the usual barriers, which
+   *  is safe because it has done nothing that they would have done
+   *  differently.
+   */
+  TM_FASTCALL void write_read_only(stm::STM_WRITE_SIG(tx,addr,val,mask))
+  {
+      ++tx->num_ro_writes;
+      stm::end_read_only(tx);
+      tx->tmwrite(tx, addr, val STM_MASK(mask));
+  }
+} // (anonymous namespace)
+
 namespace stm
 {
+  /*** the lazy switch counter */
+  pad_word_t switch_epoch = {0};
 
   void install_algorithm_local(int new_alg, TxThread* tx)
   {
-      // set my read/write/commit pointers
+      // set my read/write/commit/rollback pointers
       tx->tmread     = stms[new_alg].read;
       tx->tmwrite    = stms[new_alg].write;
       tx->tmcommit   = stms[new_alg].commit;
+      tx->tmrollback = stms[new_alg].rollback;
+      tx->installed_alg = new_alg;
+  }
+
+  /**
+   *  Install a new algorithm without waiting for in-flight transactions, if
+   *  it is in the current algorithm's family.
+   *
+   *  We still take begin_blocker, but only long enough to publish the new
+   *  algorithm and bump switch_epoch; we never wait on anyone's scope.
+   *  Holding begin_blocker keeps us exclusive with the blocking protocols,
+   *  and then begin_switcher (rather than the new algorithm's begin) keeps
+   *  them out until every thread has caught up: they all CAS tmbegin from
+   *  stms[curr_policy.ALG_ID].begin, which will fail.
+   *
+   *  In-flight transactions keep their old per-thread pointers, including
+   *  rollback, and finish under the old algorithm.  That is only safe
+   *  because the two algorithms are in the same family, which is also why we
+   *  don't call the switcher: the family's metadata invariants already hold,
+   *  and the switchers assume quiescence (e.g., NOrec's would 'fix' an odd
+   *  seqlock that an in-flight TML writer holds).
+   *
+   *  NB: we don't move the caller eagerly.  It is usually inside a commit or
+   *      rollback that is about to reset its own pointers, so it catches up
+   *      in begin_switcher like everyone else.
+   */
+  bool install_algorithm_lazy(int new_alg, TxThread* tx)
+  {
+      uint64_t start = tick();
+      int old_alg = curr_policy.ALG_ID;
+      if (!can_switch_lazily(old_alg, new_alg))
+          return false;
+      if (!bcasptr(&TxThread::tmbegin, stms[old_alg].begin, &begin_blocker))
+          return false;
+      // in case old_alg's begin is shared with whatever replaced it
+      if (curr_policy.ALG_ID != (uint32_t)old_alg) {
+          CFENCE;
+          TxThread::tmbegin = stms[old_alg].begin;
+          return false;
+      }
+
+      // diagnostic message
+      if (tx)
+          printf("[%u] switching from %s to %s (non-blocking)\n", tx->id,
+                 stms[old_alg].name, stms[new_alg].name);
+
+      TxThread::tmirrevoc = stms[new_alg].irrevoc;
+      curr_policy.ALG_ID  = new_alg;
+      ++switch_epoch.val;
+      if (tx)
+          tx->trace.record(start, TRACE_SWITCH, new_alg);
+
+      switch_stats.drain_start = start;
+      switch_stats.lazy_cycles += tick() - start;
+      ++switch_stats.lazy;
+      CFENCE;
+      TxThread::tmbegin = begin_switcher;
+      return true;
+  }
+
+  /**
+   *  Once no thread is running the old algorithm, replace begin_switcher
+   *  with the current algorithm's begin.
+   *
+   *  We first check without blocking anyone, so that threads that are
+   *  starting transactions don't repeatedly stall each other while a
+   *  straggler finishes.  Then we take begin_blocker, which makes scope a
+   *  reliable in-transaction flag: a stale thread that is in a transaction
+   *  means we give up and try again later; a stale thread that is not can
+   *  be moved remotely, just like install_algorithm does.
+   */
+  void finish_lazy_switch()
+  {
+      if (TxThread::tmbegin != begin_switcher)
+          return;
+
+      uintptr_t epoch = switch_epoch.val;
+      for (unsigned i = 0; i < threadcount.val; ++i)
+          if ((threads[i]->alg_epoch != epoch) && threads[i]->scope)
+              return;
+
+      if (!bcasptr(&TxThread::tmbegin, &begin_switcher, &begin_blocker))
+          return;
+
+      for (unsigned i = 0; i < threadcount.val; ++i) {
+          if (threads[i]->alg_epoch == epoch)
+              continue;
+          if (threads[i]->scope) {
+              CFENCE;
+              TxThread::tmbegin = begin_switcher;
+              return;
+          }
+          catch_up(threads[i]);
+      }
+
+      uint64_t drain = tick() - switch_stats.drain_start;
+      switch_stats.drain_cycles += drain;
+      switch_stats.drain_max = MAXIMUM(switch_stats.drain_max, drain);
+      ++switch_stats.drained;
+      CFENCE;
+      TxThread::tmbegin = stms[curr_policy.ALG_ID].begin;
+  }
+
+  /**
+   *  While begin_switcher is installed, curr_policy.ALG_ID and switch_epoch
+   *  can't change, since no other switch can start.
+   */
+  bool begin_switcher(TxThread* tx)
+  {
+      if (tx->alg_epoch != switch_epoch.val)
+          catch_up(tx);
+      finish_lazy_switch();
+      return stms[curr_policy.ALG_ID].begin(tx);
+  }
+
+  void record_blocking_switch(uint64_t cycles)
+  {
+      ++switch_stats.blocking;
+      switch_stats.blocking_cycles += cycles;
+  }
+
+  void dump_switch_stats()
+  {
+      if (!switch_stats.blocking && !switch_stats.lazy)
+          return;
+      std::cout << "Algorithm switches: " << switch_stats.blocking
+                << " blocking (avg "
+                << (switch_stats.blocking
+                    ? switch_stats.blocking_cycles / switch_stats.blocking : 0)
+                << " cycles); " << switch_stats.lazy
+                << " non-blocking (avg "
+                << (switch_stats.lazy
+                    ? switch_stats.lazy_cycles / switch_stats.lazy : 0)
+                << " cycles, avg drain "
+                << (switch_stats.drained
+                    ? switch_stats.drain_cycles / switch_stats.drained : 0)
+                << " cycles, max drain " << switch_stats.drain_max
+                << " cycles)" << std::endl;
+  }
+
+  uint64_t switch_count()
+  {
+      return switch_stats.blocking + switch_stats.lazy;
   }
 
   /**
@@ -53,6 +254,8 @@ namespace stm
       if (!stms[new_alg].privatization_safe)
           printf("Warning: Algorithm %s is not privatization-safe!\n",
                  stms[new_alg].name);
+      if (tx)
+          tx->trace.record(tick(), TRACE_SWITCH, new_alg);
 
       // we need to make sure the metadata remains healthy
       //
@@ -67,14 +270,72 @@ namespace stm
           threads[i]->tmread     = stms[new_alg].read;
           threads[i]->tmwrite    = stms[new_alg].write;
           threads[i]->tmcommit   = stms[new_alg].commit;
+          threads[i]->tmrollback = stms[new_alg].rollback;
+          threads[i]->installed_alg = new_alg;
           threads[i]->consec_aborts  = 0;
       }
 
-      TxThread::tmrollback = stms[new_alg].rollback;
       TxThread::tmirrevoc  = stms[new_alg].irrevoc;
       curr_policy.ALG_ID   = new_alg;
       CFENCE;
       TxThread::tmbegin    = stms[new_alg].begin;
   }
 
+  /**
+   *  A transaction that is declared read-only gets its algorithm's
+   *  read-only read and commit, if the algorithm has them, and a write
+   *  barrier that catches the write that it promised not to do.  If
+   *  something else has wrapped or replaced the barriers (the profiler's
+   *  sampler, say), we leave them alone, and the declaration does nothing.
+   *  The same goes for static-dispatch builds, whose program calls the
+   *  algorithm's barriers directly, and so could not be upgraded.
+   */
+  void begin_read_only(TxThread* tx)
+  {
+#ifdef STM_STATIC_DISPATCH
+      return;
+#endif
+      const alg_t& alg = stms[tx->installed_alg];
+      if ((tx->tmread != alg.read) || (tx->tmwrite != alg.write) ||
+          (tx->tmcommit != alg.commit))
+          return;
+      tx->read_only = true;
+      if (alg.ro_read)
+          tx->tmread = alg.ro_read;
+      if (alg.ro_commit)
+          tx->tmcommit = alg.ro_commit;
+      tx->tmwrite = write_read_only;
+  }
+
+  /*** put back the barriers that a transaction usually starts with */
+  void end_read_only(TxThread* tx)
+  {
+      const alg_t& alg = stms[tx->installed_alg];
+      tx->read_only = false;
+      tx->tmread    = alg.read;
+      tx->tmwrite   = alg.write;
+      tx->tmcommit  = alg.commit;
+  }
+
+  /**
+   *  Called by commit() right before tmcommit, if the transaction made
+   *  commutative updates (see deferred.hpp).  If the algorithm's commit can
+   *  do them, we just make sure that it is the writer's commit.  If it
+   *  can't, or if someone else's barriers are installed (irrevocability or
+   *  the sampler, say), then we replay them through the barriers.
+   */
+  void commit_deferred(TxThread* tx)
+  {
+      const alg_t& alg = stms[tx->installed_alg];
+      if (alg.defer && (tx->tmrollback == alg.rollback)) {
+          if (tx->read_only)
+              end_read_only(tx);
+          alg.defer(tx);
+          return;
+      }
+      foreach (DeferredList, i, tx->deferred)
+          i->replay(i->addr, i->val, tx);
+      tx->deferred.reset();
+  }
+
 } // namespace stm
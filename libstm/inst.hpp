@@ -15,6 +15,7 @@
 
 #include <stm/config.h>
 #include <common/platform.hpp>
+#include <stm/metadata.hpp>
 
 namespace stm
 {
@@ -27,6 +28,50 @@ namespace stm
   /*** make just this thread use a new algorith (use in ctors) */
   void install_algorithm_local(int new_alg, TxThread* tx);
 
+  /**
+   *  Switch to an algorithm in the same metadata family as the current one,
+   *  without waiting for in-flight transactions.  Returns false (and
+   *  changes nothing) if the algorithms are in different families, or if
+   *  some other switch, thread creation, or irrevocability is in progress.
+   */
+  bool install_algorithm_lazy(int new_alg, TxThread* tx);
+
+  /**
+   *  Uninstall begin_switcher if every thread has caught up with the last
+   *  lazy switch.  Never waits on another thread's transaction.
+   */
+  void finish_lazy_switch();
+
+  /**
+   *  The begin function that is installed while a lazy switch drains: it
+   *  moves the calling thread to the current algorithm before starting the
+   *  transaction.
+   */
+  bool begin_switcher(TxThread* tx) TM_FASTCALL;
+
+  /**
+   *  Count of lazy switches.  A thread whose alg_epoch differs from this is
+   *  still using the algorithm that preceded the last switch.
+   */
+  extern pad_word_t switch_epoch;
+
+  /**
+   *  Give a transaction that was declared read-only its algorithm's
+   *  read-only barriers, and take them away again (the declarations are
+   *  also in library.hpp)
+   */
+  void begin_read_only(TxThread* tx);
+  void end_read_only(TxThread* tx);
+
+  /*** record the latency of a blocking switch, in cycles */
+  void record_blocking_switch(uint64_t cycles);
+
+  /*** print the switch counts and latencies */
+  void dump_switch_stats();
+
+  /*** the number of switches (blocking and lazy) so far */
+  uint64_t switch_count();
+
 } // namespace stm
 
 #endif // INST_HPP__
@@ -16,6 +16,8 @@
 #include "policies/policies.hpp" // curr_policy
 #include "algs/algs.hpp"         // stms
 #include "algs/tml_inline.hpp"
+#include "inst.hpp"              // switch_epoch
+#include "sites.hpp"             // site_begin, site_pin
 
 using stm::UNRECOVERABLE;
 using stm::TxThread;
@@ -67,6 +69,7 @@ namespace {
       tx.tmwrite          = stms[curr_policy.ALG_ID].write;
       tx.tmcommit         = stms[curr_policy.ALG_ID].commit;
       tx.tmrollback       = stms[curr_policy.ALG_ID].rollback;
+      tx.installed_alg    = curr_policy.ALG_ID;
       TxThread::tmirrevoc = stms[curr_policy.ALG_ID].irrevoc;
       tx.tmabort          = old_abort_handler;
   }
@@ -105,6 +108,7 @@ namespace {
       TxThread::tmirrevoc = stms[CGL].irrevoc;
       old_abort_handler   = tx.tmabort;
       tx.tmabort          = abort_irrevocable;
+      tx.trace.record(tick(), stm::TRACE_IRREVOC, 0);
   }
 }
 
@@ -129,6 +133,23 @@ namespace stm
   void become_irrevoc()
   {
       TxThread* tx = Self;
+      // if a lazy switch happened since we began, we're running the prior
+      // algorithm, and neither the checks below nor tmirrevoc apply to us.
+      // Restart under the current algorithm.
+      if (tx->alg_epoch != switch_epoch.val)
+          tx->tmabort(tx);
+
+      // likewise if our atomic block picked some other member of the
+      // family; from now on, the block will use the current algorithm
+      if (stm::site_pin(tx))
+          tx->tmabort(tx);
+
+      // a declared read-only transaction's barriers (TML's commit_ro, say)
+      // assume that it never writes, which an irrevocable transaction may
+      // do, so give it the usual ones first
+      if (tx->read_only)
+          end_read_only(tx);
+
       // special code for degenerate STM implementations
       //
       // NB: stm::is_irrevoc relies on how this works, so if it changes then
@@ -244,9 +265,11 @@ namespace stm
           bool TM_FASTCALL (*beginner)(TxThread*) = TxThread::tmbegin;
           // if begin_blocker is no longer installed, we can call the pointer
           // to start a transaction, and then return.  Otherwise, we missed our
-          // window, so we need to go back to the top of the loop.
+          // window, so we need to go back to the top of the loop.  With
+          // per-site selection, site_begin also fixes up our barriers.
           if (beginner != begin_blocker)
-              return beginner(tx);
+              return TxThread::site_select ? site_begin(tx, tx->site)
+                                           : beginner(tx);
       }
   }
 }
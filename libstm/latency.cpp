@@ -0,0 +1,79 @@
+/**
+ *  Copyright (C) 2011
+ *  University of Rochester Department of Computer Science
+ *    and
+ *  Lehigh University Department of Computer Science and Engineering
+ *
+ * License: Modified BSD
+ *          Please see the file LICENSE.RSTM for licensing information
+ */
+
+/**
+ *  This file implements the latency report (see include/stm/latency.hpp).
+ *
+ *  At shutdown, we merge every thread's histograms and print the 50th, 90th,
+ *  99th and 99.9th percentiles of each.  A percentile is the upper bound of
+ *  the bucket that holds it, so it overestimates by at most 25%.  Set
+ *  STM_LATENCY_BUCKETS to also print the non-empty buckets, as
+ *  <lower bound>:<count> pairs.
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <stm/latency.hpp>
+#include <stm/txthread.hpp>
+#include <stm/lib_globals.hpp>
+
+namespace stm
+{
+  uint64_t log_histogram_t::percentile(double p) const
+  {
+      uint64_t want = (uint64_t)(count * p / 100);
+      uint64_t seen = 0;
+      for (uint32_t i = 0; i < BUCKETS; ++i) {
+          seen += buckets[i];
+          if (seen > want) {
+              uint64_t upper = (i + 1 < BUCKETS) ? lower(i + 1) - 1 : max;
+              return (upper < max) ? upper : max;
+          }
+      }
+      return max;
+  }
+
+  void log_histogram_t::dump(const char* name, const char* unit) const
+  {
+      printf("Latency %s (%s): %llu samples; p50 %llu, p90 %llu, p99 %llu, "
+             "p99.9 %llu, max %llu\n", name, unit, (unsigned long long)count,
+             (unsigned long long)percentile(50),
+             (unsigned long long)percentile(90),
+             (unsigned long long)percentile(99),
+             (unsigned long long)percentile(99.9),
+             (unsigned long long)max);
+      if (!getenv("STM_LATENCY_BUCKETS"))
+          return;
+      printf("latency_histogram %s:", name);
+      for (uint32_t i = 0; i < BUCKETS; ++i)
+          if (buckets[i])
+              printf(" %llu:%llu", (unsigned long long)lower(i),
+                     (unsigned long long)buckets[i]);
+      printf("\n");
+  }
+
+  void dump_latency_stats()
+  {
+#ifdef STM_LATENCY_YES
+      // a local (about 6KB), so that dumping twice doesn't count twice
+      latency_histograms_t all;
+      for (uint32_t i = 0; i < threadcount.val; ++i) {
+          all.txn.merge(threads[i]->latency.txn);
+          all.commit.merge(threads[i]->latency.commit);
+          all.retries.merge(threads[i]->latency.retries);
+      }
+      if (!all.txn.count)
+          return;
+      all.txn.dump("txn", "cycles");
+      all.commit.dump("commit", "cycles");
+      all.retries.dump("retries", "aborts");
+#endif
+  }
+} // namespace stm
@@ -0,0 +1,169 @@
+/**
+ *  Copyright (C) 2011
+ *  University of Rochester Department of Computer Science
+ *    and
+ *  Lehigh University Department of Computer Science and Engineering
+ *
+ * License: Modified BSD
+ *          Please see the file LICENSE.RSTM for licensing information
+ */
+
+/**
+ *  This file implements the hardware counters (see include/stm/perfctr.hpp).
+ *
+ *  Each thread opens one perf_event group, led by the cycle counter, so that
+ *  a single read() returns all of its counters.  We count user mode only,
+ *  which is what an unprivileged process may count, and which is where the
+ *  barriers run anyway.  A counter that the machine doesn't have is left out
+ *  of the group, and reported as such.
+ */
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <unistd.h>
+#include <stm/perfctr.hpp>
+#ifdef STM_OS_LINUX
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+#include <stm/txthread.hpp>
+#include <stm/lib_globals.hpp>
+#include "policies/policies.hpp" // curr_policy
+#include "algs/algs.hpp"         // stms, ALG_MAX
+
+namespace
+{
+  using namespace stm;
+
+  const char* const PERF_NAMES[PERF_COUNTERS] = {
+      "cycles", "instructions", "LLC misses"
+  };
+
+  /*** why the first thread that failed to open a counter couldn't */
+  char     why_not[128];
+  uint32_t missing = 0;   // bitmask of perf_counter_t that we couldn't open
+
+  void note_failure(perf_counter_t c, const char* why)
+  {
+      if (!why_not[0])
+          snprintf(why_not, sizeof(why_not), "%s: %s", PERF_NAMES[c], why);
+      __sync_fetch_and_or(&missing, 1u << c);
+  }
+
+#ifdef STM_OS_LINUX
+  const uint64_t CONFIGS[PERF_COUNTERS] = {
+      PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+      PERF_COUNT_HW_CACHE_MISSES
+  };
+
+  /*** count this thread, on any cpu, in user mode */
+  int open_counter(perf_counter_t c, int leader)
+  {
+      perf_event_attr a;
+      memset(&a, 0, sizeof(a));
+      a.type = PERF_TYPE_HARDWARE;
+      a.size = sizeof(a);
+      a.config = CONFIGS[c];
+      a.read_format = PERF_FORMAT_GROUP;
+      a.exclude_kernel = 1;
+      a.exclude_hv = 1;
+      int fd = syscall(__NR_perf_event_open, &a, 0, -1, leader, 0);
+      if (fd < 0)
+          note_failure(c, strerror(errno));
+      return fd;
+  }
+#endif
+
+  /*** read the whole group into 'out'; false if the read failed */
+  bool read_group(int fd, const int32_t* slot, uint64_t* out)
+  {
+      uint64_t buf[1 + PERF_COUNTERS];
+      ssize_t n = read(fd, buf, sizeof(buf));
+      if (n < (ssize_t)sizeof(uint64_t))
+          return false;
+      for (int i = 0; i < PERF_COUNTERS; ++i)
+          out[i] = (slot[i] >= 0 && (uint64_t)slot[i] < buf[0])
+                 ? buf[1 + slot[i]] : 0;
+      return true;
+  }
+} // (anonymous namespace)
+
+namespace stm
+{
+  void perf_counters_t::attach()
+  {
+#ifdef STM_OS_LINUX
+      fd = open_counter(PERF_CYCLES, -1);
+      if (fd < 0)
+          return;
+      slot[PERF_CYCLES] = 0;
+      int next = 1;
+      for (int c = PERF_CYCLES + 1; c < PERF_COUNTERS; ++c)
+          if (open_counter((perf_counter_t)c, fd) >= 0)
+              slot[c] = next++;
+      totals = (perf_totals_t*)calloc(ALG_MAX * PERF_OUTCOMES,
+                                      sizeof(perf_totals_t));
+#else
+      note_failure(PERF_CYCLES, "perf_event is Linux-only");
+#endif
+  }
+
+  void perf_counters_t::begin(const TxThread* tx)
+  {
+      alg = TxThread::site_select ? tx->site_alg : curr_policy.ALG_ID;
+      read_group(fd, slot, start);
+  }
+
+  void perf_counters_t::end(perf_outcome_t outcome)
+  {
+      uint64_t now[PERF_COUNTERS];
+      if (!read_group(fd, slot, now))
+          return;
+      perf_totals_t& t = totals[alg * PERF_OUTCOMES + outcome];
+      ++t.attempts;
+      for (int i = 0; i < PERF_COUNTERS; ++i)
+          t.counts[i] += now[i] - start[i];
+  }
+
+  void dump_perf_stats()
+  {
+#ifdef STM_PERFCTR_YES
+      if (missing & (1u << PERF_CYCLES)) {
+          printf("Perf counters: unavailable (%s)\n", why_not);
+          return;
+      }
+      if (missing)
+          printf("Perf counters: some unavailable (%s)\n", why_not);
+      static const char* const OUTCOMES[PERF_OUTCOMES] = {"commit", "abort"};
+      for (int a = 0; a < ALG_MAX; ++a) {
+          for (int o = 0; o < PERF_OUTCOMES; ++o) {
+              perf_totals_t sum;
+              memset(&sum, 0, sizeof(sum));
+              for (uint32_t i = 0; i < threadcount.val; ++i) {
+                  const perf_totals_t* t = threads[i]->perf.totals;
+                  if (!t)
+                      continue;
+                  sum.attempts += t[a * PERF_OUTCOMES + o].attempts;
+                  for (int c = 0; c < PERF_COUNTERS; ++c)
+                      sum.counts[c] += t[a * PERF_OUTCOMES + o].counts[c];
+              }
+              if (!sum.attempts)
+                  continue;
+              double n = sum.attempts;
+              printf("Perf %s %s: %llu attempts; per attempt %.0f cycles, "
+                     "%.0f instructions (IPC %.2f), %.1f LLC misses\n",
+                     stms[a].name, OUTCOMES[o],
+                     (unsigned long long)sum.attempts,
+                     sum.counts[PERF_CYCLES] / n,
+                     sum.counts[PERF_INSTRUCTIONS] / n,
+                     sum.counts[PERF_CYCLES]
+                     ? (double)sum.counts[PERF_INSTRUCTIONS]
+                           / sum.counts[PERF_CYCLES] : 0.0,
+                     sum.counts[PERF_LLC_MISSES] / n);
+          }
+      }
+#endif
+  }
+} // namespace stm
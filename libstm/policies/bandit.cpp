@@ -0,0 +1,226 @@
+/**
+ *  Copyright (C) 2011
+ *  University of Rochester Department of Computer Science
+ *    and
+ *  Lehigh University Department of Computer Science and Engineering
+ *
+ * License: Modified BSD
+ *          Please see the file LICENSE.RSTM for licensing information
+ */
+
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include "initializers.hpp" // init_pol_bandit
+#include "policies.hpp"     // init_adapt_pol
+#include "../profiling.hpp"
+#include "../algs/algs.hpp"
+
+using namespace stm;
+
+/**
+ *  This file implements policies that treat the choice of algorithm as a
+ *  multi-armed bandit.  Every commitInterval commits (as counted by thread
+ *  1), the decider credits the current algorithm with the commit throughput
+ *  that all threads achieved since the last decision, and then picks the
+ *  next algorithm to run.  No qtable or profile is needed: the policy
+ *  explores the candidate algorithms online, and converges on whichever one
+ *  performs best.
+ *
+ *  The arms are taken from STM_BANDIT_ARMS (a comma-separated list of
+ *  algorithm names), the interval from STM_BANDIT_INTERVAL, and the
+ *  exploration rate of the epsilon-greedy variant from STM_BANDIT_EPSILON
+ *  (a percentage).
+ *
+ *  NB: as with the other policies, semantics are the user's concern: every
+ *      arm must be safe for the workload.
+ *
+ *  NB: interval decisions need STM_PROFILETMTRIGGER_ALL.  With the
+ *      pathology trigger, the bandit only runs on abort and wait triggers.
+ */
+namespace
+{
+  const int MAX_ARMS = 16;
+
+  /*** per-arm statistics */
+  struct arm_t
+  {
+      uint32_t alg;               // ALG_ID of this arm
+      uint32_t pulls;             // intervals credited to this arm
+      double   mean;              // mean commits per million cycles
+  };
+
+  arm_t    arms[MAX_ARMS];
+  int      num_arms   = 0;
+  uint32_t pulls      = 0;        // total intervals credited
+  uint32_t epsilon    = 5;        // exploration percentage
+  uint32_t seed       = 1;        // for epsilon-greedy exploration
+
+  /*** the measurement in progress */
+  uint64_t last_time    = 0;
+  uint64_t last_commits = 0;
+
+  /*** only one decision at a time; racing triggers keep the current alg */
+  volatile uintptr_t deciding = 0;
+
+  /**
+   *  Once an arm has this many pulls, weight new rewards by 1/STEP rather
+   *  than 1/pulls, so that the means track a workload that changes phase.
+   */
+  const uint32_t STEP = 8;
+
+  /*** the total commit count, across all threads */
+  uint64_t total_commits()
+  {
+      uint64_t c = 0;
+      for (uint32_t i = 0; i < threadcount.val; ++i)
+          c += threads[i]->num_commits + threads[i]->num_ro;
+      return c;
+  }
+
+  /**
+   *  Credit the interval that just ended to the arm for the current
+   *  algorithm, and start a new interval.
+   */
+  void credit()
+  {
+      uint64_t now = tick();
+      uint64_t commits = total_commits();
+      if (last_time && now > last_time) {
+          double reward =
+              (1000000.0 * (commits - last_commits)) / (now - last_time);
+          for (int i = 0; i < num_arms; ++i) {
+              if (arms[i].alg != curr_policy.ALG_ID)
+                  continue;
+              ++arms[i].pulls;
+              ++pulls;
+              uint32_t n = (arms[i].pulls < STEP) ? arms[i].pulls : STEP;
+              arms[i].mean += (reward - arms[i].mean) / n;
+              break;
+          }
+      }
+      last_time = now;
+      last_commits = commits;
+  }
+
+  /*** pull every arm once before trusting any mean */
+  int unexplored()
+  {
+      for (int i = 0; i < num_arms; ++i)
+          if (!arms[i].pulls)
+              return i;
+      return -1;
+  }
+
+  /*** the arm with the best mean reward */
+  int greedy()
+  {
+      int best = 0;
+      for (int i = 1; i < num_arms; ++i)
+          if (arms[i].mean > arms[best].mean)
+              best = i;
+      return best;
+  }
+
+  /**
+   *  Epsilon-greedy: usually exploit the best arm, but explore a random arm
+   *  epsilon percent of the time
+   */
+  int choose_eg()
+  {
+      seed = seed * 1103515245 + 12345;
+      if (((seed >> 16) % 100) < epsilon)
+          return (seed >> 8) % num_arms;
+      return greedy();
+  }
+
+  /**
+   *  UCB1: pick the arm with the best upper confidence bound.  Rewards are
+   *  normalized to the best mean, so that the bonus term is on the same
+   *  scale whatever the absolute throughput is.
+   */
+  int choose_ucb()
+  {
+      double top = arms[greedy()].mean;
+      if (top <= 0)
+          top = 1;
+      int best = 0;
+      double best_ucb = -1;
+      for (int i = 0; i < num_arms; ++i) {
+          double ucb = arms[i].mean / top +
+              sqrt(2.0 * log((double)pulls) / arms[i].pulls);
+          if (ucb > best_ucb) {
+              best_ucb = ucb;
+              best = i;
+          }
+      }
+      return best;
+  }
+
+  /*** the shared decider, instantiated for each selection rule */
+  template <int (*CHOOSE)()>
+  TM_FASTCALL uint32_t pol_bandit()
+  {
+      if (!bcasptr(&deciding, (uintptr_t)0, (uintptr_t)1))
+          return curr_policy.ALG_ID;
+      credit();
+      int next = unexplored();
+      if (next < 0)
+          next = CHOOSE();
+      CFENCE;
+      deciding = 0;
+      return arms[next].alg;
+  }
+
+  /*** parse STM_BANDIT_ARMS, or use the same default set as CBR training */
+  void init_arms()
+  {
+      const char* cfg = getenv("STM_BANDIT_ARMS");
+      char buf[1024];
+      strncpy(buf, cfg ? cfg : "NOrec,OrecLazy,OrecEager,RingSW",
+              sizeof(buf) - 1);
+      buf[sizeof(buf) - 1] = '\0';
+      char* save;
+      for (char* a = strtok_r(buf, ",", &save); a && num_arms < MAX_ARMS;
+           a = strtok_r(NULL, ",", &save))
+      {
+          int id = stm_name_map(a);
+          if (id < 0) {
+              printf("STM_BANDIT_ARMS: ignoring unknown algorithm %s\n", a);
+              continue;
+          }
+          arms[num_arms].alg = id;
+          arms[num_arms].pulls = 0;
+          arms[num_arms].mean = 0;
+          num_arms++;
+      }
+      if (!num_arms)
+          UNRECOVERABLE("STM_BANDIT_ARMS does not name any algorithm");
+  }
+} // namespace { }
+
+namespace stm
+{
+  /**
+   *  Initialize the bandit policies.  Both start on the first arm.
+   */
+  void init_pol_bandit()
+  {
+      init_arms();
+
+      uint32_t interval = 4096;
+      if (const char* s = getenv("STM_BANDIT_INTERVAL"))
+          interval = strtol(s, 0, 10);
+      if (!interval)
+          interval = 1;
+      if (const char* s = getenv("STM_BANDIT_EPSILON"))
+          epsilon = strtol(s, 0, 10);
+
+      init_adapt_pol(Bandit_EG, arms[0].alg, 16, 2048, false, false, true,
+                     pol_bandit<choose_eg>, "Bandit_EG");
+      init_adapt_pol(Bandit_UCB, arms[0].alg, 16, 2048, false, false, true,
+                     pol_bandit<choose_ucb>, "Bandit_UCB");
+      pols[Bandit_EG].commitInterval = interval;
+      pols[Bandit_UCB].commitInterval = interval;
+  }
+} // namespace stm
@@ -16,6 +16,7 @@ namespace stm
   /*** Initializers for the various classes of adaptivity policies */
   void init_pol_static();
   void init_pol_cbr();
+  void init_pol_bandit();
 }
 
 #endif // STM_POLICIES_INITIALIZERS_HPP
@@ -10,6 +10,11 @@
 
 #include <iostream>
 #include <fstream>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include "policies.hpp"
 #include "initializers.hpp"    // init_pol_*
 #include "../algs/algs.hpp"
@@ -96,6 +101,121 @@ namespace
       std::cout << "Qtable Initialization:  loaded " << count << " lines from "
                 << qstr << std::endl;
   }
+
+  /**
+   *  Binary qtable format
+   *
+   *    The training mode of the benchmark harness produces a compact binary
+   *    qtable instead of the .q file described above.  The file is a header
+   *    followed by fixed-size records, so that several training runs
+   *    (i.e., several benchmark binaries) can simply append to the same file,
+   *    and so that pol_init can mmap the file rather than parse it.
+   *
+   *    NB: records hold the algorithm *name*, not its ALG_ID, so that a
+   *        table remains valid when the set of algorithms changes.
+   */
+  const char     QTABLE_MAGIC[8] = {'R','S','T','M','Q','T','B','L'};
+  const uint32_t QTABLE_VERSION  = 1;
+
+  struct qfile_header_t
+  {
+      char     magic[8];
+      uint32_t version;
+      uint32_t reclen;            // sizeof(qfile_rec_t) of the writer
+  };
+
+  struct qfile_rec_t
+  {
+      char     bm[48];            // benchmark that produced this record
+      char     alg[32];           // best algorithm at this thread count
+      uint32_t thr;
+      uint32_t read_ro;
+      uint32_t read_rw_nonraw;
+      uint32_t read_rw_raw;
+      uint32_t write_nonwaw;
+      uint32_t write_waw;
+      uint64_t txn_time;
+      uint32_t txn_ratio;         // pct_txtime
+      uint32_t pct_ro;            // roratio
+  };
+
+  /**
+   *  mmap a binary qtable and copy its records into qtbl.  Returns false if
+   *  the file is not a binary qtable, so that the caller can fall back to
+   *  the .q parser.
+   */
+  bool load_qtable_bin(const char* qstr)
+  {
+      int fd = open(qstr, O_RDONLY);
+      if (fd < 0)
+          return false;
+      struct stat st;
+      if (fstat(fd, &st) || (size_t)st.st_size < sizeof(qfile_header_t)) {
+          close(fd);
+          return false;
+      }
+      void* map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+      close(fd);
+      if (map == MAP_FAILED)
+          return false;
+
+      const qfile_header_t* h = static_cast<const qfile_header_t*>(map);
+      if (memcmp(h->magic, QTABLE_MAGIC, sizeof(QTABLE_MAGIC))) {
+          munmap(map, st.st_size);
+          return false;
+      }
+      if (h->version != QTABLE_VERSION || h->reclen != sizeof(qfile_rec_t))
+          UNRECOVERABLE("Qtable file has an incompatible version");
+
+      const qfile_rec_t* recs = reinterpret_cast<const qfile_rec_t*>(h + 1);
+      size_t nrecs = (st.st_size - sizeof(*h)) / sizeof(qfile_rec_t);
+      int count = 0;
+      for (size_t i = 0; i < nrecs; ++i) {
+          const qfile_rec_t& r = recs[i];
+          // the names come from the file, so don't trust them to end
+          if (!memchr(r.alg, 0, sizeof(r.alg)) ||
+              !memchr(r.bm, 0, sizeof(r.bm)))
+          {
+              std::cerr << "Qtable Initialization:  skipping record " << i
+                        << ", which has an unterminated name" << std::endl;
+              continue;
+          }
+          qtable_t q;
+          q.alg_name = stm_name_map(r.alg);
+          q.thr      = r.thr;
+          if (q.alg_name < 0 || r.thr > MAX_THREADS) {
+              std::cerr << "Qtable Initialization:  skipping record for "
+                        << r.alg << " at " << r.thr << " threads" << std::endl;
+              continue;
+          }
+          q.p.read_ro        = r.read_ro;
+          q.p.read_rw_nonraw = r.read_rw_nonraw;
+          q.p.read_rw_raw    = r.read_rw_raw;
+          q.p.write_nonwaw   = r.write_nonwaw;
+          q.p.write_waw      = r.write_waw;
+          q.p.txn_time       = r.txn_time;
+          q.txn_ratio        = r.txn_ratio;
+          q.pct_ro           = r.pct_ro;
+          if (qtbl[q.thr] == NULL)
+              qtbl[q.thr] = new MiniVector<qtable_t>(64);
+          qtbl[q.thr]->insert(q);
+          count++;
+      }
+      munmap(map, st.st_size);
+
+      std::cout << "Qtable Initialization:  loaded " << count
+                << " binary records from " << qstr << std::endl;
+      return true;
+  }
+
+  /**
+   *  Training state: the counters at train_profile_begin, and the behavior
+   *  summary computed by train_profile_end.
+   */
+  uint32_t    train_txns;
+  uint32_t    train_ro;
+  uint64_t    train_nontxn;
+  qfile_rec_t train_row;
 } // namespace {}
 
 namespace stm
@@ -150,11 +270,100 @@ namespace stm
       // call all initialization functions
       init_pol_static();
       init_pol_cbr();
+      init_pol_bandit();
 
       // load in the qtable here
       char* qstr = getenv("STM_QTABLE");
-      if (qstr != NULL)
+      if (qstr != NULL && !load_qtable_bin(qstr))
           load_qtable(qstr);
   }
 
+  /**
+   *  Start profiling a training run.  The caller must have switched to a
+   *  ProfileApp algorithm, and no transactions may be running.
+   */
+  void train_profile_begin()
+  {
+      train_txns = train_ro = 0;
+      train_nontxn = 0;
+      for (uint32_t i = 0; i < threadcount.val; i++) {
+          train_txns   += threads[i]->num_commits + threads[i]->num_ro;
+          train_ro     += threads[i]->num_ro;
+          // don't charge the time since the last run as nontxn work
+          threads[i]->end_txn_time = 0;
+          train_nontxn += threads[i]->total_nontxn_time;
+      }
+      if (app_profiles)
+          app_profiles->clear();
+  }
+
+  /**
+   *  Finish profiling a training run, and summarize the workload behavior
+   *  the same way sys_shutdown does for ProfileApp.
+   */
+  void train_profile_end()
+  {
+      uint32_t txns = 0, ro = 0;
+      uint64_t nontxn = 0;
+      for (uint32_t i = 0; i < threadcount.val; i++) {
+          txns   += threads[i]->num_commits + threads[i]->num_ro;
+          ro     += threads[i]->num_ro;
+          nontxn += threads[i]->total_nontxn_time;
+      }
+      txns   -= train_txns;
+      ro     -= train_ro;
+      nontxn -= train_nontxn;
+
+      if (!app_profiles)
+          UNRECOVERABLE("train_profile_end called without ProfileApp");
+
+      uint32_t divisor =
+          (curr_policy.ALG_ID == ProfileAppAvg) ? txns : 1;
+      if (divisor == 0)
+          divisor = 0u - 1u;
+
+      memset(&train_row, 0, sizeof(train_row));
+      train_row.read_ro        = app_profiles->read_ro / divisor;
+      train_row.read_rw_nonraw = app_profiles->read_rw_nonraw / divisor;
+      train_row.read_rw_raw    = app_profiles->read_rw_raw / divisor;
+      train_row.write_nonwaw   = app_profiles->write_nonwaw / divisor;
+      train_row.write_waw      = app_profiles->write_waw / divisor;
+      train_row.txn_time       = app_profiles->txn_time / divisor;
+      train_row.txn_ratio      =
+          nontxn ? (100 * app_profiles->timecounter) / nontxn : 100;
+      train_row.pct_ro         = txns ? (100 * ro) / txns : 0;
+  }
+
+  /**
+   *  Append a record for the most recent profile to a binary qtable,
+   *  creating the file (and its header) if it does not exist.
+   */
+  bool train_write_row(const char* file, const char* bm, const char* alg,
+                       uint32_t threads)
+  {
+      int fd = open(file, O_WRONLY | O_CREAT | O_APPEND, 0644);
+      if (fd < 0)
+          return false;
+      struct stat st;
+      if (fstat(fd, &st)) {
+          close(fd);
+          return false;
+      }
+      bool ok = true;
+      if (st.st_size == 0) {
+          qfile_header_t h;
+          memcpy(h.magic, QTABLE_MAGIC, sizeof(QTABLE_MAGIC));
+          h.version = QTABLE_VERSION;
+          h.reclen  = sizeof(qfile_rec_t);
+          ok = write(fd, &h, sizeof(h)) == (ssize_t)sizeof(h);
+      }
+      qfile_rec_t r = train_row;
+      strncpy(r.bm, bm, sizeof(r.bm) - 1);
+      strncpy(r.alg, alg, sizeof(r.alg) - 1);
+      r.thr = threads;
+      ok = ok && (write(fd, &r, sizeof(r)) == (ssize_t)sizeof(r));
+      close(fd);
+      return ok;
+  }
+
 } // namespace stm
@@ -51,11 +51,17 @@ namespace stm
       /*** does the policy have commit-based reprofiling? */
       bool isCommitProfile;
 
+      /**
+       *  if nonzero, trigger every commitInterval commits of thread 1 rather
+       *  than on CommitTrigger's decaying schedule
+       */
+      uint32_t commitInterval;
+
       /*** the decision policy function pointer */
       uint32_t (*TM_FASTCALL decider) ();
 
       /*** simple ctor, because a NULL name is a bad thing */
-      pol_t() : name(""){ }
+      pol_t() : name(""), commitInterval(0) { }
   };
 
   /**
@@ -266,6 +272,8 @@ namespace stm
       CBR_TxnRatio_W_Time, CBR_TxnRatio_RO_Time, CBR_TxnRatio_RW_RO,
       CBR_TxnRatio_RW_Time, CBR_TxnRatio_R_RO_Time, CBR_TxnRatio_W_RO_Time,
       CBR_TxnRatio_RW_RO_Time,
+      // online selection, without a qtable
+      Bandit_EG, Bandit_UCB,
       // max value... this always goes last
       POL_MAX
   };
@@ -23,6 +23,229 @@ using namespace stm;
 
 namespace
 {
+  /**
+   *  Per-thread state for a sampled transaction.  While a transaction is
+   *  being sampled, its per-thread barrier pointers are the *_sample
+   *  functions below, and the algorithm's own pointers live here.
+   */
+  struct sampler_t
+  {
+      ReadBarrier   read;       // the algorithm's read barrier
+      WriteBarrier  write;      // the algorithm's write barrier
+      CommitBarrier commit;     // the algorithm's commit barrier
+      scope_t*    (*rollback)(STM_ROLLBACK_SIG(,,)); // and its rollback
+      uintptr_t     slot;       // the entry of profiles[] we are filling
+      bool          wrote;      // has the sampled transaction written yet
+      uint32_t      count;      // transactions begun, to pick every Nth one
+      WriteSet*     writes;     // addresses written, for RAW/WAW counts
+  };
+
+  /*** sampling state for each thread */
+  sampler_t samplers[MAX_THREADS];
+
+  /*** the begin function that was current when sampling started */
+  bool TM_FASTCALL (*sample_begin)(TxThread*) = NULL;
+
+  /*** next profiles[] entry to hand out, and number of entries filled */
+  pad_word_t sample_next = {0};
+  pad_word_t sample_done = {0};
+
+  void change_algorithm(TxThread* tx, unsigned new_algorithm);
+
+  TM_FASTCALL bool begin_sampler(TxThread*);
+  TM_FASTCALL void* read_sample(STM_READ_SIG(,,));
+  TM_FASTCALL void write_sample(STM_WRITE_SIG(,,,));
+  TM_FASTCALL void commit_sample(TxThread*);
+  scope_t* rollback_sample(STM_ROLLBACK_SIG(,,));
+
+  /**
+   *  The algorithm may replace our barriers mid-transaction (e.g., via
+   *  OnFirstWrite).  When it does, remember its choice and put ours back.
+   */
+  inline void rewrap(TxThread* tx, sampler_t& s)
+  {
+      if (tx->tmread != read_sample) {
+          s.read = tx->tmread;
+          tx->tmread = read_sample;
+      }
+      if (tx->tmwrite != write_sample) {
+          s.write = tx->tmwrite;
+          tx->tmwrite = write_sample;
+      }
+      if (tx->tmcommit != commit_sample) {
+          s.commit = tx->tmcommit;
+          tx->tmcommit = commit_sample;
+      }
+  }
+
+  /**
+   *  Once every requested sample is in, stop sampling and let the policy
+   *  pick an algorithm, just like profile_oncomplete does for ProfileTM.
+   *
+   *  Nobody else can have installed begin_blocker while begin_sampler is
+   *  installed, but if thread creation or set_policy abandoned the samples
+   *  while we took the last one, then they hold begin_blocker, and there is
+   *  nothing to decide.
+   */
+  void sample_oncomplete(TxThread* tx)
+  {
+      if (!bcasptr(&TxThread::tmbegin, &begin_sampler,
+                   stms[curr_policy.ALG_ID].begin))
+          return;
+      uint32_t new_algorithm = pols[curr_policy.POL_ID].decider();
+      change_algorithm(tx, new_algorithm);
+  }
+
+  /**
+   *  Finish a sample (committed or aborted, as in ProfileTM), and restore
+   *  the algorithm's barriers.  The algorithm may have already reset them
+   *  during commit or rollback, in which case we leave them alone.
+   */
+  void end_sample(TxThread* tx, sampler_t& s)
+  {
+      dynprof_t& p = profiles[s.slot];
+      p.txn_time = tick() - p.txn_time;
+      int x = s.writes->size();
+      p.write_nonwaw = x;
+      p.write_waw -= x;
+      s.writes->reset();
+
+      if (tx->tmread == read_sample)
+          tx->tmread = s.read;
+      if (tx->tmwrite == write_sample)
+          tx->tmwrite = s.write;
+      if (tx->tmcommit == commit_sample)
+          tx->tmcommit = s.commit;
+      tx->tmrollback = s.rollback;
+
+      if (faiptr(&sample_done.val) + 1 == profile_txns)
+          sample_oncomplete(tx);
+  }
+
+  /**
+   *  Sampled read: classify it the way ProfileTM does, then run the
+   *  algorithm's read.
+   */
+  void* read_sample(STM_READ_SIG(tx,addr,mask))
+  {
+      sampler_t& s = samplers[tx->id-1];
+      if (!s.wrote) {
+          ++profiles[s.slot].read_ro;
+      }
+      else {
+          WriteSetEntry log(STM_WRITE_SET_ENTRY(addr, NULL, mask));
+          if (s.writes->find(log))
+              ++profiles[s.slot].read_rw_raw;
+          else
+              ++profiles[s.slot].read_rw_nonraw;
+      }
+      void* val = s.read(tx, addr STM_MASK(mask));
+      rewrap(tx, s);
+      return val;
+  }
+
+  /**
+   *  Sampled write: log the address so we can count WAW writes at the end,
+   *  then run the algorithm's write.
+   */
+  void write_sample(STM_WRITE_SIG(tx,addr,val,mask))
+  {
+      sampler_t& s = samplers[tx->id-1];
+      s.wrote = true;
+      s.writes->insert(WriteSetEntry(STM_WRITE_SET_ENTRY(addr, NULL, mask)));
+      ++profiles[s.slot].write_waw;
+      s.write(tx, addr, val STM_MASK(mask));
+      rewrap(tx, s);
+  }
+
+  /*** Sampled commit: if the algorithm's commit returns, we committed */
+  void commit_sample(TxThread* tx)
+  {
+      sampler_t& s = samplers[tx->id-1];
+      s.commit(tx);
+      end_sample(tx, s);
+  }
+
+  /*** Sampled rollback: roll back, then finish the sample */
+  scope_t* rollback_sample(STM_ROLLBACK_SIG(tx, except, len))
+  {
+      sampler_t& s = samplers[tx->id-1];
+#if defined(STM_ABORT_ON_THROW)
+      scope_t* scope = s.rollback(tx, except, len);
+#else
+      scope_t* scope = s.rollback(tx);
+#endif
+      end_sample(tx, s);
+      return scope;
+  }
+
+  /**
+   *  The begin function that is installed while we sample.  It starts the
+   *  transaction with the algorithm that was current when sampling began,
+   *  and then decides whether to sample it.
+   *
+   *  NB: A thread can get here after sampling finished, if it read tmbegin
+   *      just before sample_oncomplete reset it.  Using sample_begin rather
+   *      than curr_policy.ALG_ID keeps such a thread consistent with its
+   *      barrier pointers, even if a lazy switch has happened since: the
+   *      thread just looks like a straggler to that switch.
+   */
+  bool begin_sampler(TxThread* tx)
+  {
+      bool irrevocable = sample_begin(tx);
+      sampler_t& s = samplers[tx->id-1];
+      if (irrevocable || (sample_threads && (tx->id > sample_threads)))
+          return irrevocable;
+      if (++s.count % sample_rate)
+          return irrevocable;
+      uintptr_t slot = faiptr(&sample_next.val);
+      if (slot >= profile_txns)
+          return irrevocable;
+
+      // claim the slot and wrap the barriers
+      if (!s.writes)
+          s.writes = new WriteSet(64);
+      s.slot = slot;
+      s.wrote = false;
+      profiles[slot].clear();
+      profiles[slot].txn_time = tick();
+      s.read = tx->tmread;
+      s.write = tx->tmwrite;
+      s.commit = tx->tmcommit;
+      s.rollback = tx->tmrollback;
+      tx->tmread = read_sample;
+      tx->tmwrite = write_sample;
+      tx->tmcommit = commit_sample;
+      tx->tmrollback = rollback_sample;
+      return false;
+  }
+
+  /**
+   *  Start sampling.  We only hold begin_blocker long enough to reset the
+   *  counters; nobody waits for in-flight transactions.
+   *
+   *  NB: CTokenTurbo and Pipeline decide whether they are in turbo mode by
+   *      comparing tx->tmread to their turbo barrier, which our wrappers
+   *      would hide, so they still profile with ProfileTM.
+   */
+  bool start_sampling(TxThread* tx)
+  {
+      uint32_t alg = curr_policy.ALG_ID;
+      if ((alg == CTokenTurbo) || (alg == Pipeline))
+          return false;
+
+      if (!bcasptr(&TxThread::tmbegin, stms[alg].begin, &begin_blocker))
+          return true;
+
+      curr_policy.PREPROFILE_ALG = alg;
+      sample_begin = stms[alg].begin;
+      sample_next.val = 0;
+      sample_done.val = 0;
+      CFENCE;
+      TxThread::tmbegin = begin_sampler;
+      return true;
+  }
+
   /**
    *  If we change the algorithm, then we need to reset the wait and abort
    *  thresholds.  If we do not change the algorithm, then if we revisited our
@@ -53,6 +276,15 @@ namespace
    */
   void collect_profiles(TxThread* tx)
   {
+      // unless we've been asked for ProfileTM, sample concurrently
+      if (sample_rate && start_sampling(tx))
+          return;
+
+      uint64_t start = tick();
+
+      // NB: ProfileTM doesn't share metadata with anything, so this is
+      //     always a blocking switch
+
       // prevent new txns from starting
       if (!bcasptr(&TxThread::tmbegin, stms[curr_policy.ALG_ID].begin,
                    &begin_blocker))
@@ -68,6 +300,7 @@ namespace
 
       // install ProfileTM
       install_algorithm(ProfileTM, tx);
+      record_blocking_switch(tick() - start);
   }
 
   /**
@@ -80,6 +313,15 @@ namespace
       //     they were the same, then we could just adjust the thresholds
       //     without doing any other work.  For now, we ignore that
       //     optimization
+      uint64_t start = tick();
+
+      // if the new algorithm shares metadata with the current one, switch
+      // without waiting for in-flight transactions
+      uint32_t old_algorithm = curr_policy.ALG_ID;
+      if (install_algorithm_lazy(new_algorithm, tx)) {
+          adjust_thresholds(new_algorithm, old_algorithm);
+          return;
+      }
 
       // prevent new txns from starting
       if (!bcasptr(&TxThread::tmbegin, stms[curr_policy.ALG_ID].begin,
@@ -96,6 +338,7 @@ namespace
 
       // update the instrumentation level
       install_algorithm(new_algorithm, tx);
+      record_blocking_switch(tick() - start);
   }
 
 } // (anonymous namespace)
@@ -105,6 +348,12 @@ namespace stm
   /*** The next CommitTrigger commit threshold */
   unsigned CommitTrigger::next = 1;
 
+  /*** Sample one in this many transactions; 0 means use ProfileTM */
+  uint32_t sample_rate = 16;
+
+  /*** Only threads with id <= this take samples; 0 means all threads */
+  uint32_t sample_threads = 0;
+
   /**
    * When a ProfileTM transaction commits, we end up in this code, which
    * calls the current policy's 'decider' to pick the new algorithm, and then
@@ -112,6 +361,8 @@ namespace stm
    */
   void profile_oncomplete(TxThread* tx)
   {
+      uint64_t start = tick();
+
       // NB: This is subtle: When we switched /to/ ProfileTM, we installed
       //     begin_blocker, then changed algorithms via install_algorithm(),
       //     then uninstalled begin_blocker.  We are about to call
@@ -139,6 +390,20 @@ namespace stm
 
       // update the instrumentation level and install the algorithm
       install_algorithm(new_algorithm, tx);
+      record_blocking_switch(tick() - start);
+  }
+
+  /**
+   *  Transactions that are being sampled finish as usual, and end_sample
+   *  restores their barriers.  We just make sure that nobody claims another
+   *  slot, and that the last sample doesn't call the decider.
+   */
+  bool abandon_sampling()
+  {
+      if (!bcasptr(&TxThread::tmbegin, &begin_sampler, &begin_blocker))
+          return false;
+      sample_next.val = profile_txns;
+      return true;
   }
 
   void trigger_common(TxThread* tx)
@@ -152,6 +417,14 @@ namespace stm
       // This will lead to either changing algorithms, or resetting the local
       // consec abort counter.
       uint32_t new_algorithm = pols[curr_policy.POL_ID].decider();
+      // an interval policy that keeps its algorithm needs no switch, just
+      // the usual backoff if this was a repeat selection on abort
+      if (pols[curr_policy.POL_ID].commitInterval &&
+          new_algorithm == curr_policy.ALG_ID)
+      {
+          adjust_thresholds(new_algorithm, new_algorithm);
+          return;
+      }
       change_algorithm(tx, new_algorithm);
   }
 } // namespace stm
@@ -33,6 +33,25 @@ namespace stm
   /*** After profiles are collected, select and install a new algorithm */
   void profile_oncomplete(TxThread* tx);
 
+  /**
+   *  Profiles are normally collected by sampling one in every sample_rate
+   *  transactions on threads whose id is at most sample_threads (0 means
+   *  every thread), while the current algorithm keeps running.  A
+   *  sample_rate of 0 selects ProfileTM, which runs the profiled
+   *  transactions serially instead.
+   */
+  extern uint32_t sample_rate;
+  extern uint32_t sample_threads;
+
+  /**
+   *  Thread creation and set_policy need begin_blocker, and must not wait
+   *  for the remaining samples, since the threads that would take them may
+   *  be waiting on the caller.  If profiles are being sampled, this drops
+   *  them and installs begin_blocker in place of the sampler, and returns
+   *  true.
+   */
+  bool abandon_sampling();
+
   /**
    * custom begin method that blocks the starting thread, in order to get
    * rendezvous correct during mode switching and GRL irrevocability
@@ -139,6 +158,15 @@ namespace stm
           // return if this policy doesn't allow commit-time probing
           if (!pols[curr_policy.POL_ID].isCommitProfile)
               return;
+          // interval policies trigger on a fixed period of thread 1 commits
+          if (uint32_t interval = pols[curr_policy.POL_ID].commitInterval) {
+              if ((tx->id != 1) ||
+                  ((tx->num_ro + tx->num_commits) % interval))
+                  return;
+              curr_policy.abort_switch = false;
+              trigger_common(tx);
+              return;
+          }
           // return if not thread#2
           if (tx->id != 2)
               return;
@@ -0,0 +1,166 @@
+/**
+ *  Copyright (C) 2011
+ *  University of Rochester Department of Computer Science
+ *    and
+ *  Lehigh University Department of Computer Science and Engineering
+ *
+ * License: Modified BSD
+ *          Please see the file LICENSE.RSTM for licensing information
+ */
+
+/**
+ *  This file implements the bulk barriers of the library API:
+ *  stm_read_range, stm_write_range, and stm_memcpy (see library.hpp).
+ *
+ *  A range is cut into a partial word at either end, which goes through the
+ *  masked word barriers just like a char or short would, and a run of whole
+ *  words in between.  If the thread is running its algorithm's own
+ *  barriers, and the algorithm has bulk versions of them (see
+ *  alg_t::read_range), the run is a single call.  Otherwise, it is a call to
+ *  tmread or tmwrite per word, which is what the caller would have done
+ *  anyway.
+ *
+ *  As with DISPATCH, writing part of a word reads and rewrites the whole
+ *  word, so the caveat about granular lost updates applies here too.
+ */
+
+#include <cstring>
+#include <stm/txthread.hpp>
+#include "algs/algs.hpp"
+
+namespace
+{
+  using namespace stm;
+
+  const size_t WORD = sizeof(void*);
+
+  /*** the mask of n bytes starting at byte off of a word */
+  inline uintptr_t byte_mask(size_t off, size_t n)
+  {
+      uintptr_t m = (n == WORD) ? ~(uintptr_t)0
+                                : (((uintptr_t)1 << (8 * n)) - 1);
+      return m << (8 * off);
+  }
+
+  /*** read n bytes at offset off of the word at a into buf */
+  void read_part(TxThread* tx, void** a, size_t off, size_t n, char* buf)
+  {
+      void* v = tx->tmread(tx, a STM_MASK(byte_mask(off, n)));
+      memcpy(buf, (char*)&v + off, n);
+  }
+
+  /*** write n bytes of buf at offset off of the word at a */
+  void write_part(TxThread* tx, void** a, size_t off, size_t n,
+                  const char* buf)
+  {
+      void* v = tx->tmread(tx, a STM_MASK(byte_mask(off, n)));
+      memcpy((char*)&v + off, buf, n);
+      tx->tmwrite(tx, a, v STM_MASK(byte_mask(off, n)));
+  }
+
+  /*** read a run of whole words */
+  void read_words(TxThread* tx, void** a, char* buf, size_t words)
+  {
+      const alg_t& alg = stms[tx->installed_alg];
+      if (alg.read_range &&
+          ((tx->tmread == alg.read) || (tx->tmread == alg.ro_read)))
+      {
+          alg.read_range(tx, a, buf, words);
+          return;
+      }
+      for (size_t i = 0; i < words; ++i, buf += WORD) {
+          void* v = tx->tmread(tx, a + i STM_MASK(~0x0));
+          memcpy(buf, &v, WORD);
+      }
+  }
+
+  /*** write a run of whole words */
+  void write_words(TxThread* tx, void** a, const char* buf, size_t words)
+  {
+      const alg_t& alg = stms[tx->installed_alg];
+      if (alg.write_range && (tx->tmwrite == alg.write)) {
+          alg.write_range(tx, a, buf, words);
+          return;
+      }
+      for (size_t i = 0; i < words; ++i, buf += WORD) {
+          void* v;
+          memcpy(&v, buf, WORD);
+          tx->tmwrite(tx, a + i, v STM_MASK(~0x0));
+      }
+  }
+} // (anonymous namespace)
+
+namespace stm
+{
+  void stm_read_range(void* dst, const void* src, size_t len, TxThread* tx)
+  {
+      if (!len)
+          return;
+#ifdef STM_CAPTURE_YES
+      if (tx->allocator.captured(src, len)) {
+          memcpy(dst, src, len);
+          return;
+      }
+#endif
+      char* out = (char*)dst;
+      uintptr_t addr = (uintptr_t)src;
+
+      // the partial word at the start
+      size_t off = addr & (WORD - 1);
+      if (off) {
+          size_t n = (len < WORD - off) ? len : WORD - off;
+          read_part(tx, (void**)(addr - off), off, n, out);
+          addr += n;
+          out += n;
+          len -= n;
+      }
+
+      // the whole words, then what is left
+      read_words(tx, (void**)addr, out, len / WORD);
+      size_t whole = len & ~(WORD - 1);
+      if (len != whole)
+          read_part(tx, (void**)(addr + whole), 0, len - whole, out + whole);
+  }
+
+  void stm_write_range(void* dst, const void* src, size_t len, TxThread* tx)
+  {
+      if (!len)
+          return;
+#ifdef STM_CAPTURE_YES
+      if (tx->allocator.captured(dst, len)) {
+          memcpy(dst, src, len);
+          return;
+      }
+#endif
+      const char* in = (const char*)src;
+      uintptr_t addr = (uintptr_t)dst;
+
+      size_t off = addr & (WORD - 1);
+      if (off) {
+          size_t n = (len < WORD - off) ? len : WORD - off;
+          write_part(tx, (void**)(addr - off), off, n, in);
+          addr += n;
+          in += n;
+          len -= n;
+      }
+
+      write_words(tx, (void**)addr, in, len / WORD);
+      size_t whole = len & ~(WORD - 1);
+      if (len != whole)
+          write_part(tx, (void**)(addr + whole), 0, len - whole, in + whole);
+  }
+
+  /**
+   *  Both sides are shared, so we bounce through a buffer on the stack.
+   *  Like memcpy, the ranges must not overlap.
+   */
+  void stm_memcpy(void* dst, const void* src, size_t len, TxThread* tx)
+  {
+      char buf[256];
+      for (size_t done = 0; done < len; done += sizeof(buf)) {
+          size_t n = (len - done < sizeof(buf)) ? len - done : sizeof(buf);
+          stm_read_range(buf, (const char*)src + done, n, tx);
+          stm_write_range((char*)dst + done, buf, n, tx);
+      }
+  }
+} // namespace stm
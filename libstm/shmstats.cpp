@@ -0,0 +1,184 @@
+/**
+ *  Copyright (C) 2011
+ *  University of Rochester Department of Computer Science
+ *    and
+ *  Lehigh University Department of Computer Science and Engineering
+ *
+ * License: Modified BSD
+ *          Please see the file LICENSE.RSTM for licensing information
+ */
+
+/**
+ *  This file publishes live statistics in a POSIX shared memory segment (see
+ *  include/stm/shmstats.hpp for the layout, and tools/stmstat.cpp for a
+ *  reader).
+ *
+ *  The counters that sys_shutdown prints are only ever written by their own
+ *  thread, so a background thread can read them racily without slowing
+ *  anyone down.  Every STM_SHM_INTERVAL milliseconds, it copies them into
+ *  the segment, under the segment's sequence lock.
+ *
+ *  To enable it, set STM_SHM_STATS to the name of the segment (e.g., /rstm),
+ *  or to 1 to use /rstm-<pid>.  The segment is removed at sys_shutdown.
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <fcntl.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <stm/shmstats.hpp>
+#include <stm/txthread.hpp>
+#include <stm/lib_globals.hpp>
+#include "inst.hpp"              // switch_count
+#include "policies/policies.hpp" // curr_policy
+#include "algs/algs.hpp"         // stms
+
+namespace
+{
+  using namespace stm;
+
+  shm_stats_t*   seg = NULL;
+  char           seg_name[64];
+  uint32_t       interval_ms = 1000;
+  pthread_t      publisher;
+  bool           publishing = false;
+  pthread_mutex_t publisher_lock = PTHREAD_MUTEX_INITIALIZER;
+  pthread_cond_t  publisher_wake = PTHREAD_COND_INITIALIZER;
+
+  /*** add one thread's counters to 'out' */
+  void collect(const TxThread* tx, shm_thread_stats_t& out)
+  {
+      out.commits       += tx->num_commits;
+      out.ro_commits    += tx->num_ro;
+      out.aborts        += tx->num_aborts;
+      out.restarts      += tx->num_restarts;
+      out.txn_cycles    += tx->total_txn_time;
+      out.nontxn_cycles += tx->total_nontxn_time;
+#ifdef STM_CONFLICTS_YES
+      for (int k = 0; k < CONFLICT_KINDS; ++k)
+          out.causes[k] += tx->conflicts.counts[k];
+#endif
+  }
+
+  /*** copy a name into a fixed-size field */
+  void set_name(char* field, const char* name)
+  {
+      strncpy(field, name ? name : "", SHM_STATS_NAMELEN - 1);
+      field[SHM_STATS_NAMELEN - 1] = '\0';
+  }
+
+  /*** rewrite the segment, under its sequence lock */
+  void publish()
+  {
+      uint32_t count = threadcount.val;
+
+      seg->seq = seg->seq + 1;
+      WBR;
+      seg->timestamp = tick();
+      seg->switches = switch_count();
+      seg->threads = count;
+      set_name(seg->algorithm, stms[curr_policy.ALG_ID].name);
+      set_name(seg->policy, pols[curr_policy.POL_ID].name);
+      memset(&seg->total, 0, sizeof(seg->total));
+      for (uint32_t i = 0; i < count; ++i) {
+          memset(&seg->thread[i], 0, sizeof(seg->thread[i]));
+          collect(threads[i], seg->thread[i]);
+          collect(threads[i], seg->total);
+      }
+      ++seg->updates;
+      WBR;
+      seg->seq = seg->seq + 1;
+  }
+
+  /*** publish every interval_ms, until shmstats_shutdown wakes us */
+  void* publisher_main(void*)
+  {
+      pthread_mutex_lock(&publisher_lock);
+      while (publishing) {
+          publish();
+          timespec until;
+          clock_gettime(CLOCK_REALTIME, &until);
+          uint64_t ns = until.tv_nsec + (uint64_t)interval_ms * 1000000;
+          until.tv_sec += ns / 1000000000;
+          until.tv_nsec = ns % 1000000000;
+          pthread_cond_timedwait(&publisher_wake, &publisher_lock, &until);
+      }
+      pthread_mutex_unlock(&publisher_lock);
+      return NULL;
+  }
+} // (anonymous namespace)
+
+namespace stm
+{
+  void shmstats_init()
+  {
+      const char* name = getenv("STM_SHM_STATS");
+      if (!name)
+          return;
+      if (!strcmp(name, "1"))
+          snprintf(seg_name, sizeof(seg_name), "/rstm-%d", (int)getpid());
+      else
+          snprintf(seg_name, sizeof(seg_name), "%s%s",
+                   (name[0] == '/') ? "" : "/", name);
+      if (const char* ms = getenv("STM_SHM_INTERVAL"))
+          interval_ms = strtol(ms, 0, 10);
+
+      int fd = shm_open(seg_name, O_CREAT | O_RDWR, 0644);
+      if (fd < 0) {
+          perror("STM_SHM_STATS: shm_open");
+          return;
+      }
+      if (ftruncate(fd, sizeof(shm_stats_t)) != 0) {
+          perror("STM_SHM_STATS: ftruncate");
+          close(fd);
+          return;
+      }
+      void* p = mmap(NULL, sizeof(shm_stats_t), PROT_READ | PROT_WRITE,
+                     MAP_SHARED, fd, 0);
+      close(fd);
+      if (p == MAP_FAILED) {
+          perror("STM_SHM_STATS: mmap");
+          return;
+      }
+
+      seg = (shm_stats_t*)p;
+      memset(seg, 0, sizeof(shm_stats_t));
+      seg->version = SHM_STATS_VERSION;
+      seg->size = sizeof(shm_stats_t);
+      seg->pid = getpid();
+#ifdef STM_CONFLICTS_YES
+      seg->causes_valid = 1;
+#endif
+      // readers check the magic last
+      WBR;
+      memcpy(seg->magic, SHM_STATS_MAGIC, sizeof(seg->magic));
+
+      publishing = true;
+      if (pthread_create(&publisher, NULL, publisher_main, NULL) != 0) {
+          perror("STM_SHM_STATS: pthread_create");
+          publishing = false;
+      }
+      printf("Publishing statistics in shared memory segment %s\n", seg_name);
+  }
+
+  void shmstats_shutdown()
+  {
+      if (!seg)
+          return;
+      pthread_mutex_lock(&publisher_lock);
+      bool running = publishing;
+      publishing = false;
+      pthread_cond_signal(&publisher_wake);
+      pthread_mutex_unlock(&publisher_lock);
+      if (running)
+          pthread_join(publisher, NULL);
+      publish();
+      munmap(seg, sizeof(shm_stats_t));
+      seg = NULL;
+      shm_unlink(seg_name);
+  }
+} // namespace stm
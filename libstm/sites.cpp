@@ -0,0 +1,281 @@
+/**
+ *  Copyright (C) 2011
+ *  University of Rochester Department of Computer Science
+ *    and
+ *  Lehigh University Department of Computer Science and Engineering
+ *
+ * License: Modified BSD
+ *          Please see the file LICENSE.RSTM for licensing information
+ */
+
+/**
+ *  This file implements per-atomic-block algorithm selection.
+ *
+ *  The adaptivity policies pick one algorithm for the whole program.  When
+ *  that algorithm is in a metadata family (see install_algorithm_lazy), any
+ *  other member of the family can run at the same time as it, so each
+ *  atomic block can use whichever member suits it: a long read-mostly block
+ *  might run NOrec while a short write-heavy one runs TML.
+ *
+ *  Each block's site_t indexes a profile.  We measure the time from a
+ *  transaction's first begin to its commit (so aborted attempts count),
+ *  averaged over a window of commits.  We try every family member once,
+ *  and then run the cheapest, re-trying the others every so often in case
+ *  the workload changes.  Note that the cost of a block's choice to *other*
+ *  blocks (e.g., a TML writer aborting NOrec readers) only shows up in
+ *  their own measurements.
+ *
+ *  The tricky part is that the rest of the library assumes that a thread's
+ *  barriers are the current algorithm's whenever the thread is outside of
+ *  a transaction.  Instead, site_begin installs the right barriers every
+ *  time a transaction begins, and it only writes them when no other thread
+ *  can be writing them too: our scope is set, and begin_blocker is not
+ *  installed.  When begin_blocker is installed, it calls back into
+ *  site_begin once it is uninstalled.
+ */
+
+#include <iostream>
+#include "sites.hpp"
+#include "inst.hpp"              // install_algorithm_local
+#include "profiling.hpp"         // begin_blocker
+#include "policies/policies.hpp" // curr_policy
+#include "algs/algs.hpp"         // stms
+
+namespace
+{
+  using namespace stm;
+
+  const uint32_t MAX_SITES    = 1024; // later blocks use the current alg
+  const int      MAX_MEMBERS  = 16;   // per family
+  const int      MAX_FAMILIES = 8;
+  const uint32_t WINDOW       = 64;   // commits per measurement
+  const uint32_t EXPLORE      = 16;   // re-try another member this often
+  const uint64_t OUTLIER      = 8;    // cap samples at this * best mean
+
+  /*** the algorithms in each family */
+  struct family_t
+  {
+      int      count;
+      uint32_t algs[MAX_MEMBERS];
+  };
+
+  family_t families[MAX_FAMILIES];
+
+  /**
+   *  The profile of an atomic block.  Only the thread that wins 'busy'
+   *  changes the choice; the window counters are updated racily, which only
+   *  makes the measurements a little noisier.
+   */
+  struct site_prof_t
+  {
+      volatile uintptr_t busy;
+      volatile int       family;     // family of 'arm', NoFamily if unset
+      volatile int32_t   arm;        // index into families[family]
+      bool               pinned;     // always use the current algorithm
+      uint32_t           window;     // commits in this measurement
+      uint64_t           cycles;     // and their total time
+      uint32_t           decisions;
+      uint64_t           commits;
+      uint64_t           cap;        // longest sample we believe, or 0
+      uint32_t           pulls[MAX_MEMBERS];
+      uint64_t           mean[MAX_MEMBERS]; // cycles per commit
+  };
+
+  site_prof_t*      sites = NULL;
+  volatile uint32_t site_count = 0;
+
+  /*** a block's id while its first user is assigning one */
+  const uint32_t SITE_CLAIMED = ~0u;
+
+  /**
+   *  get a block's profile, assigning it an id on first use.  Only the
+   *  thread that claims the block takes an id, and anyone else waits for
+   *  it, so that racing threads don't use up ids.
+   */
+  site_prof_t* profile_of(site_t* site)
+  {
+      if (!site->id && bcas32(&site->id, 0u, SITE_CLAIMED))
+          site->id = fai32(&site_count) + 1;
+      uint32_t id;
+      while ((id = site->id) == SITE_CLAIMED)
+          spin64();
+      return (id <= MAX_SITES) ? &sites[id - 1] : NULL;
+  }
+
+  /**
+   *  Start choosing from a new family (e.g., at the first use, or after a
+   *  blocking switch), beginning with the current algorithm
+   */
+  void reset(site_prof_t& s, int fam, uint32_t curr)
+  {
+      s.arm = 0;
+      for (int i = 0; i < families[fam].count; ++i) {
+          s.pulls[i] = 0;
+          s.mean[i] = 0;
+          if (families[fam].algs[i] == curr)
+              s.arm = i;
+      }
+      s.window = 0;
+      s.cycles = 0;
+      s.cap = 0;
+      CFENCE;
+      s.family = fam;
+  }
+
+  /*** the member of curr's family that a block should run, or -1 */
+  int32_t choose(site_t* site, uint32_t curr)
+  {
+      site_prof_t* s = profile_of(site);
+      int fam = stms[curr].family;
+      if (!s || s->pinned || fam == NoFamily || fam >= MAX_FAMILIES)
+          return -1;
+      if (s->family != fam) {
+          if (!bcasptr(&s->busy, (uintptr_t)0, (uintptr_t)1))
+              return -1;
+          if (s->family != fam)
+              reset(*s, fam, curr);
+          CFENCE;
+          s->busy = 0;
+      }
+      return s->arm;
+  }
+
+  /*** end a measurement window, and pick the member to run next */
+  void decide(site_prof_t& s)
+  {
+      const family_t& f = families[s.family];
+      int a = s.arm;
+      uint64_t avg = s.cycles / s.window;
+      s.mean[a] = s.pulls[a] ? (3 * s.mean[a] + avg) / 4 : avg;
+      ++s.pulls[a];
+      s.window = 0;
+      s.cycles = 0;
+      ++s.decisions;
+
+      // try every member once
+      for (int i = 0; i < f.count; ++i) {
+          if (!s.pulls[i]) {
+              s.arm = i;
+              return;
+          }
+      }
+      // then run the cheapest, but keep re-trying the others
+      if ((f.count > 1) && !(s.decisions % EXPLORE)) {
+          s.arm = (a + 1 + (s.decisions / EXPLORE) % (f.count - 1)) % f.count;
+          return;
+      }
+      int best = 0;
+      for (int i = 1; i < f.count; ++i)
+          if (s.mean[i] < s.mean[best])
+              best = i;
+      s.arm = best;
+      s.cap = OUTLIER * s.mean[best];
+  }
+} // (anonymous namespace)
+
+namespace stm
+{
+  void sites_init()
+  {
+      for (int f = 0; f < MAX_FAMILIES; ++f)
+          families[f].count = 0;
+      for (int i = 0; i < ALG_MAX; ++i) {
+          int f = stms[i].family;
+          if (f != NoFamily && f < MAX_FAMILIES &&
+              families[f].count < MAX_MEMBERS)
+              families[f].algs[families[f].count++] = i;
+      }
+      sites = new site_prof_t[MAX_SITES]();
+      TxThread::site_select = true;
+  }
+
+  bool site_begin(TxThread* tx, site_t* site)
+  {
+      tx->site = site;
+      tx->site_arm = -1;
+
+      // get a consistent view of the algorithm and the begin function,
+      // unless begin_blocker is installed: then someone may be writing our
+      // barriers, so leave them alone and wait
+      uint32_t curr;
+      bool TM_FASTCALL (*beginner)(TxThread*);
+      do {
+          curr = curr_policy.ALG_ID;
+          CFENCE;
+          beginner = TxThread::tmbegin;
+          if (beginner == begin_blocker)
+              return beginner(tx);
+          CFENCE;
+      } while (curr != curr_policy.ALG_ID);
+
+      // only pick per-site while the current algorithm is running normally,
+      // i.e., not during a lazy switch or while sampling
+      uint32_t alg = curr;
+      if (site && (beginner == stms[curr].begin)) {
+          int32_t arm = choose(site, curr);
+          if (arm >= 0) {
+              tx->site_arm = arm;
+              alg = families[stms[curr].family].algs[arm];
+          }
+      }
+      tx->site_alg = alg;
+
+      // put the right barriers in place, if the last transaction left some
+      // other member's there
+      if ((tx->tmread != stms[alg].read) || (tx->tmcommit != stms[alg].commit)
+          || (tx->tmrollback != stms[alg].rollback))
+          install_algorithm_local(alg, tx);
+
+      return (alg == curr) ? beginner(tx) : stms[alg].begin(tx);
+  }
+
+  void site_commit(TxThread* tx)
+  {
+      if (tx->site_arm < 0)
+          return;
+      site_prof_t& s = sites[tx->site->id - 1];
+      // a transaction that was descheduled tells us nothing about the
+      // algorithm, so don't let it dominate the mean
+      uint64_t cycles = tx->end_txn_time - tx->txn_start;
+      s.cycles += (s.cap && cycles > s.cap) ? s.cap : cycles;
+      ++s.commits;
+      if ((++s.window < WINDOW) || (s.arm != tx->site_arm))
+          return;
+      if (!bcasptr(&s.busy, (uintptr_t)0, (uintptr_t)1))
+          return;
+      if ((s.window >= WINDOW) && (s.family != NoFamily))
+          decide(s);
+      CFENCE;
+      s.busy = 0;
+  }
+
+  bool site_pin(TxThread* tx)
+  {
+      if (!TxThread::site_select || (tx->site_arm < 0) ||
+          (tx->site_alg == curr_policy.ALG_ID))
+          return false;
+      sites[tx->site->id - 1].pinned = true;
+      return true;
+  }
+
+  void dump_site_stats()
+  {
+      if (!TxThread::site_select)
+          return;
+      uint32_t count = (site_count < MAX_SITES) ? site_count : MAX_SITES;
+      for (uint32_t i = 0; i < count; ++i) {
+          site_prof_t& s = sites[i];
+          if (s.family == NoFamily)
+              continue;
+          const family_t& f = families[s.family];
+          std::cout << "Site " << i + 1 << ": " << stms[f.algs[s.arm]].name
+                    << (s.pinned ? " (pinned)" : "") << "; Commits: "
+                    << s.commits << "; Cycles per commit:";
+          for (int a = 0; a < f.count; ++a)
+              if (s.pulls[a])
+                  std::cout << " " << stms[f.algs[a]].name << "="
+                            << s.mean[a];
+          std::cout << std::endl;
+      }
+  }
+} // namespace stm
@@ -0,0 +1,51 @@
+/**
+ *  Copyright (C) 2011
+ *  University of Rochester Department of Computer Science
+ *    and
+ *  Lehigh University Department of Computer Science and Engineering
+ *
+ * License: Modified BSD
+ *          Please see the file LICENSE.RSTM for licensing information
+ */
+
+/***  This file declares the per-atomic-block algorithm selection code */
+
+#ifndef SITES_HPP__
+#define SITES_HPP__
+
+#include <stm/config.h>
+#include <common/platform.hpp>
+#include <stm/txthread.hpp>
+
+namespace stm
+{
+  /*** turn on TxThread::site_select, and find the members of each family */
+  void sites_init();
+
+  /**
+   *  Begin a transaction for an atomic block (site may be NULL), using the
+   *  block's algorithm when it is compatible with the current one.  This
+   *  replaces the call to TxThread::tmbegin when site_select is on.
+   */
+  bool site_begin(TxThread* tx, site_t* site) TM_FASTCALL;
+
+  /**
+   *  Charge a committed transaction's time (up to its end_txn_time) to its
+   *  block's choice
+   */
+  void site_commit(TxThread* tx) TM_FASTCALL;
+
+  /**
+   *  If the transaction is running a per-site algorithm other than the
+   *  current one, make its block use the current algorithm from now on and
+   *  return true, so that the caller can restart it (e.g., to become
+   *  irrevocable).
+   */
+  bool site_pin(TxThread* tx);
+
+  /*** print each block's choices */
+  void dump_site_stats();
+
+} // namespace stm
+
+#endif // SITES_HPP__
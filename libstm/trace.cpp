@@ -0,0 +1,113 @@
+/**
+ *  Copyright (C) 2011
+ *  University of Rochester Department of Computer Science
+ *    and
+ *  Lehigh University Department of Computer Science and Engineering
+ *
+ * License: Modified BSD
+ *          Please see the file LICENSE.RSTM for licensing information
+ */
+
+/**
+ *  This file implements the trace file for the event tracer (see
+ *  include/stm/trace.hpp).
+ *
+ *  Each thread appends a whole buffer of events with a single write() to a
+ *  file opened with O_APPEND, so buffers from different threads never
+ *  interleave.  The flush happens on whichever event fills the buffer, so a
+ *  traced transaction occasionally pays for a write().
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <stm/trace.hpp>
+#include <stm/txthread.hpp>
+#include <stm/lib_globals.hpp>
+#include "algs/algs.hpp"         // stms
+#include "policies/policies.hpp" // curr_policy
+
+namespace
+{
+  using namespace stm;
+
+  int trace_fd = -1;
+
+  /*** write all of buf, or give up on tracing */
+  void write_all(const void* buf, size_t len)
+  {
+      const char* p = (const char*)buf;
+      while (len && trace_fd >= 0) {
+          ssize_t n = write(trace_fd, p, len);
+          if (n <= 0) {
+              perror("STM_TRACE: write");
+              return;
+          }
+          p += n;
+          len -= n;
+      }
+  }
+} // (anonymous namespace)
+
+namespace stm
+{
+  void trace_buffer_t::attach(uint32_t id)
+  {
+      thread = id;
+      if (trace_fd >= 0)
+          events = (trace_event_t*)malloc(SIZE * sizeof(trace_event_t));
+  }
+
+  void trace_buffer_t::flush()
+  {
+      if (events && next)
+          write_all(events, next * sizeof(trace_event_t));
+      next = 0;
+  }
+
+  void trace_init()
+  {
+      const char* file = getenv("STM_TRACE");
+      if (!file)
+          return;
+#ifndef STM_TRACE_YES
+      printf("STM_TRACE: ignored, since libstm_enable_tracing is off\n");
+#else
+      trace_fd = open(file, O_WRONLY | O_CREAT | O_TRUNC | O_APPEND, 0644);
+      if (trace_fd < 0) {
+          perror("STM_TRACE: open");
+          return;
+      }
+
+      // the header, then a table of algorithm names for switch events
+      trace_header_t h;
+      memcpy(h.magic, TRACE_MAGIC, sizeof(h.magic));
+      h.version = TRACE_VERSION;
+      h.event_size = sizeof(trace_event_t);
+      h.alg_count = ALG_MAX;
+      h.name_len = TRACE_NAMELEN;
+      h.initial_alg = curr_policy.ALG_ID;
+      h.pad = 0;
+      write_all(&h, sizeof(h));
+      for (int i = 0; i < ALG_MAX; ++i) {
+          char name[TRACE_NAMELEN] = {0};
+          if (stms[i].name)
+              strncpy(name, stms[i].name, TRACE_NAMELEN - 1);
+          write_all(name, TRACE_NAMELEN);
+      }
+      printf("Tracing transactions to %s\n", file);
+#endif
+  }
+
+  void trace_shutdown()
+  {
+      if (trace_fd < 0)
+          return;
+      for (uint32_t i = 0; i < threadcount.val; ++i)
+          threads[i]->trace.flush();
+      close(trace_fd);
+      trace_fd = -1;
+  }
+} // namespace stm
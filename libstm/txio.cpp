@@ -0,0 +1,271 @@
+/**
+ *  Copyright (C) 2011
+ *  University of Rochester Department of Computer Science
+ *    and
+ *  Lehigh University Department of Computer Science and Engineering
+ *
+ * License: Modified BSD
+ *          Please see the file LICENSE.RSTM for licensing information
+ */
+
+/**
+ *  This file implements transactional output: stm_fwrite and stm_fprintf
+ *  (see library.hpp).
+ *
+ *  A transaction's output goes into a buffer that belongs to its thread.
+ *  The first output of an attempt registers an on_commit handler and an
+ *  on_abort handler for the buffer, so a transaction can log without
+ *  becoming irrevocable.
+ *
+ *  Output is written in the order of the tickets that transactions take just
+ *  before they try to commit (txio_ticket).  A transaction that saw
+ *  another's writes must have taken its ticket after the other one started
+ *  to commit, so its output comes later, too.  A finished transaction puts
+ *  its buffer in the ring slot for its ticket (an aborted one puts it there
+ *  marked as dropped), and whoever holds the flushing flag writes out every
+ *  buffer whose turn has come.  A committed transaction then waits until
+ *  its own buffer has been written, so that output which the thread
+ *  produces after the commit can't come out ahead of it.  The wait is only
+ *  for transactions with earlier tickets, which are already committing.
+ *  Transactions that don't produce output never take a ticket.
+ */
+
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <stm/txthread.hpp>
+
+namespace stm
+{
+  /**
+   *  The output of one transaction: the bytes, and the FILE for each run of
+   *  them.  A thread reuses its buffers once they have been written out.
+   */
+  struct txio_t
+  {
+      struct run_t
+      {
+          FILE*  f;
+          size_t end;   // the run is buf[previous run's end, end)
+      };
+
+      char*              buf;
+      size_t             len;
+      size_t             cap;
+      MiniVector<run_t>  runs;
+      uintptr_t          ticket;
+      bool               ticketed;
+      bool               committed;
+      volatile bool      busy;      // in use, or waiting to be written
+
+      txio_t()
+          : buf((char*)malloc(256)), len(0), cap(256), runs(8), ticket(0),
+            ticketed(false), committed(false), busy(false)
+      {
+      }
+
+      /*** make room for n more bytes */
+      void reserve(size_t n)
+      {
+          if (len + n <= cap)
+              return;
+          while (len + n > cap)
+              cap *= 2;
+          buf = (char*)realloc(buf, cap);
+      }
+
+      /*** note that the bytes up to len go to f */
+      void append_run(FILE* f)
+      {
+          if (runs.size() && (runs.end() - 1)->f == f) {
+              (runs.end() - 1)->end = len;
+              return;
+          }
+          run_t r = { f, len };
+          runs.insert(r);
+      }
+
+      /*** write out the runs, and let the owner reuse the buffer */
+      void retire()
+      {
+          if (committed) {
+              size_t start = 0;
+              foreach (MiniVector<run_t>, i, runs) {
+                  fwrite(buf + start, 1, i->end - start, i->f);
+                  start = i->end;
+              }
+          }
+          len = 0;
+          runs.reset();
+          ticketed = false;
+          CFENCE;
+          busy = false;
+      }
+  };
+}
+
+namespace
+{
+  using namespace stm;
+
+  /*** finished transactions, by ticket */
+  const uintptr_t RING_SIZE = 256;
+  txio_t* volatile ring[RING_SIZE];
+
+  /*** the next ticket to hand out, and the next one to write out */
+  pad_word_t next_ticket = {0};
+  pad_word_t now_serving = {0};
+
+  /*** held by the thread that is writing out */
+  pad_word_t flushing = {0};
+
+  /*** each thread's buffers, which live as long as the program */
+  __thread MiniVector<txio_t*>* my_ios = NULL;
+
+  /**
+   *  Write out every buffer whose turn has come, unless someone else is
+   *  already doing it.  After letting go of the flag, look again, in case a
+   *  buffer arrived after we looked but before we let go.
+   */
+  void drain()
+  {
+      while (!flushing.val && bcasptr(&flushing.val, 0, 1)) {
+          txio_t* io;
+          uintptr_t t = now_serving.val;
+          while ((io = ring[t % RING_SIZE]) && (io->ticket == t)) {
+              ring[t % RING_SIZE] = NULL;
+              io->retire();
+              now_serving.val = ++t;
+          }
+          flushing.val = 0;
+          WBR;
+          io = ring[t % RING_SIZE];
+          if (!io || (io->ticket != t))
+              return;
+      }
+  }
+
+  /**
+   *  Once the transaction is over, put its buffer in line.  If it never took
+   *  a ticket, it aborted before trying to commit, and nobody is waiting for
+   *  it.  If it committed, don't return until its output is out.
+   */
+  void finish(txio_t* io, bool committed)
+  {
+      Self->io = NULL;
+      if (!io->ticketed) {
+          io->retire();
+          return;
+      }
+      io->committed = committed;
+
+      // the ring is only full if a transaction RING_SIZE tickets ahead of us
+      // is still committing
+      while (io->ticket - now_serving.val >= RING_SIZE)
+          yield_cpu();
+      uintptr_t ticket = io->ticket;
+      ring[ticket % RING_SIZE] = io;
+      WBR;
+      drain();
+
+      // if someone else is writing, they may not have reached us yet, and
+      // if a transaction ahead of us hasn't finished, nobody will until it
+      // does
+      if (committed) {
+          while (now_serving.val <= ticket) {
+              yield_cpu();
+              drain();
+          }
+      }
+  }
+
+  /*** the on_commit and on_abort handlers */
+  void flush(void* arg)   { finish((txio_t*)arg, true); }
+  void discard(void* arg) { finish((txio_t*)arg, false); }
+
+  /**
+   *  Get a buffer for the transaction, and if this is the attempt's first
+   *  output, register the handlers that will write or drop it
+   */
+  txio_t* get_io(TxThread* tx)
+  {
+      if (tx->io)
+          return tx->io;
+      if (!my_ios)
+          my_ios = new MiniVector<txio_t*>(4);
+
+      txio_t* io = NULL;
+      for (MiniVector<txio_t*>::iterator i = my_ios->begin();
+           i != my_ios->end(); ++i)
+      {
+          if (!(*i)->busy) {
+              io = *i;
+              break;
+          }
+      }
+      if (!io) {
+          io = new txio_t();
+          my_ios->insert(io);
+      }
+      io->busy = true;
+      tx->io = io;
+
+      handler_t c = { flush, io }, a = { discard, io };
+      tx->commit_handlers.insert(c);
+      tx->abort_handlers.insert(a);
+      return io;
+  }
+} // (anonymous namespace)
+
+namespace stm
+{
+  void stm_fwrite(const void* buf, size_t len, FILE* f, TxThread* tx)
+  {
+      if (!tx->nesting_depth) {
+          fwrite(buf, 1, len, f);
+          return;
+      }
+      txio_t* io = get_io(tx);
+      io->reserve(len);
+      memcpy(io->buf + io->len, buf, len);
+      io->len += len;
+      io->append_run(f);
+  }
+
+  void stm_fprintf(TxThread* tx, FILE* f, const char* fmt, ...)
+  {
+      va_list args;
+      if (!tx->nesting_depth) {
+          va_start(args, fmt);
+          vfprintf(f, fmt, args);
+          va_end(args);
+          return;
+      }
+
+      // try to format into the space we have, and grow it if that fails
+      txio_t* io = get_io(tx);
+      va_start(args, fmt);
+      int n = vsnprintf(io->buf + io->len, io->cap - io->len, fmt, args);
+      va_end(args);
+      if (n < 0)
+          return;
+      if ((size_t)n >= io->cap - io->len) {
+          io->reserve(n + 1);
+          va_start(args, fmt);
+          vsnprintf(io->buf + io->len, io->cap - io->len, fmt, args);
+          va_end(args);
+      }
+      io->len += n;
+      io->append_run(f);
+  }
+
+  /**
+   *  Called by commit() right before tmcommit, if the transaction has output
+   */
+  void txio_ticket(TxThread* tx)
+  {
+      tx->io->ticket = faiptr(&next_ticket.val);
+      tx->io->ticketed = true;
+  }
+} // namespace stm
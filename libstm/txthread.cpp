@@ -10,12 +10,15 @@
 
 #include <setjmp.h>
 #include <iostream>
+#include <cstring>
 #include <stm/txthread.hpp>
 #include <stm/lib_globals.hpp>
+#include <stm/static_dispatch.hpp>
 #include "policies/policies.hpp"
 #include "algs/tml_inline.hpp"
 #include "algs/algs.hpp"
 #include "inst.hpp"
+#include "sites.hpp"
 
 using namespace stm;
 
@@ -36,13 +39,16 @@ namespace
   NORETURN void
   default_abort_handler(TxThread* tx)
   {
-      jmp_buf* scope = (jmp_buf*)TxThread::tmrollback(tx
+      scope_t* scope = tx->tmrollback(tx
 #if defined(STM_ABORT_ON_THROW)
-                                                      , NULL, 0
+                                      , NULL, 0
 #endif
-                                               );
+                                     );
+      // stm::atomic() transactions restart by unwinding to their retry loop
+      if (scope == &atomic_scope)
+          throw atomic_restart();
       // need to null out the scope
-      longjmp(*scope, 1);
+      longjmp(*(jmp_buf*)scope, 1);
   }
 } // (anonymous namespace)
 
@@ -75,16 +81,23 @@ namespace stm
         my_mcslock(new mcs_qnode_t()),
         cm_ts(INT_MAX),
         cf((filter_t*)FILTER_ALLOC(sizeof(filter_t))),
-        nanorecs(64),
-        begin_wait(0),
+        nanorecs(64), deferred(16), commit_handlers(8), abort_handlers(8),
+        io(NULL), begin_wait(0),
         strong_HG(),
-        irrevocable(false)
+        irrevocable(false), end_txn_time(0), total_nontxn_time(0),
+        txn_start(0), total_txn_time(0), site(NULL), site_arm(-1),
+        site_alg(0), installed_alg(0), read_only(false), num_ro_writes(0)
   {
-      // prevent new txns from starting.
+      // prevent new txns from starting.  If a lazy switch is draining, help
+      // it finish, and if profiles are being sampled, give up on them, since
+      // the threads that either one is waiting on may never begin again.
       while (true) {
           int i = curr_policy.ALG_ID;
           if (bcasptr(&tmbegin, stms[i].begin, &begin_blocker))
               break;
+          if (abandon_sampling())
+              break;
+          finish_lazy_switch();
           spin64();
       }
 
@@ -116,6 +129,10 @@ namespace stm
       // update the allocator
       allocator.setID(id-1);
 
+      // and the tracer and hardware counters, if any
+      trace.attach(id);
+      perf.attach();
+
       // set up my lock word
       my_lock.fields.lock = 1;
       my_lock.fields.id = id;
@@ -124,8 +141,10 @@ namespace stm
       wf->clear();
       rf->clear();
 
-      // configure my TM instrumentation
+      // configure my TM instrumentation.  No lazy switch can be draining
+      // while we hold begin_blocker, so we are current.
       install_algorithm_local(curr_policy.ALG_ID, this);
+      alg_epoch = switch_epoch.val;
 
       // set the pointer to this TxThread
       threads[id-1] = this;
@@ -170,12 +189,17 @@ namespace stm
   bool TM_FASTCALL (*volatile TxThread::tmbegin)(TxThread*) = begin_CGL;
 
   /**
-   *  The tmrollback, tmabort, and tmirrevoc pointers
+   *  The tmabort and tmirrevoc pointers
    */
-  scope_t* (*TxThread::tmrollback)(STM_ROLLBACK_SIG(,,));
   NORETURN void (*TxThread::tmabort)(TxThread*) = default_abort_handler;
   bool (*TxThread::tmirrevoc)(TxThread*) = NULL;
 
+  /*** only its address matters */
+  char atomic_scope;
+
+  /*** per-site algorithm selection is off unless STM_SITES is set */
+  bool TxThread::site_select = false;
+
   /*** the init factory */
   void TxThread::thread_init()
   {
@@ -195,10 +219,28 @@ namespace stm
       TxThread* tx = Self;
       // register this restart
       ++tx->num_restarts;
+      tx->conflicts.note(CONFLICT_EXPLICIT, NULL, NULL);
       // call the abort code
       tx->tmabort(tx);
   }
 
+  /**
+   *  Undo the current transaction without restarting it, and leave the
+   *  thread outside of any transaction.  An irrevocable transaction has
+   *  already done its writes, so it is left for the caller to commit.
+   */
+  bool cancel(TxThread* tx)
+  {
+      if (is_irrevoc(*tx))
+          return false;
+      tx->tmrollback(tx
+#if defined(STM_ABORT_ON_THROW)
+                     , NULL, 0
+#endif
+                    );
+      return true;
+  }
+
 
   /**
    *  When the transactional system gets shut down, we call this to dump stats
@@ -213,6 +255,9 @@ namespace stm
       uint32_t txn_count    = 0;                // total txns
       uint32_t rw_txns      = 0;                // rw commits
       uint32_t ro_txns      = 0;                // ro commits
+      uint64_t stash_hits   = 0;                // retry allocs reused
+      uint64_t stash_misses = 0;
+      uint64_t ro_writes    = 0;                // writes in read-only txns
       for (uint32_t i = 0; i < threadcount.val; i++) {
           std::cout << "Thread: "       << threads[i]->id
                     << "; RW Commits: " << threads[i]->num_commits
@@ -224,11 +269,30 @@ namespace stm
           rw_txns += threads[i]->num_commits;
           ro_txns += threads[i]->num_ro;
           nontxn_count += threads[i]->total_nontxn_time;
+          stash_hits += threads[i]->allocator.stash_hits;
+          stash_misses += threads[i]->allocator.stash_misses;
+          ro_writes += threads[i]->num_ro_writes;
       }
       txn_count = rw_txns + ro_txns;
       pct_ro = (!txn_count) ? 0 : (100 * ro_txns) / txn_count;
 
       std::cout << "Total nontxn work:\t" << nontxn_count << std::endl;
+      if (ro_writes)
+          std::cout << "Read-only txns that wrote:\t" << ro_writes
+                    << std::endl;
+      if (stash_hits + stash_misses)
+          std::cout << "Retry allocs reused:\t" << stash_hits << " of "
+                    << (stash_hits + stash_misses) << " ("
+                    << (100 * stash_hits) / (stash_hits + stash_misses)
+                    << "%)" << std::endl;
+      dump_switch_stats();
+      dump_site_stats();
+      dump_conflict_stats();
+      dump_latency_stats();
+      dump_perf_stats();
+      shmstats_shutdown();
+      trace_shutdown();
+      WBMMPolicy::stopReclaimer();
 
       // if we ever switched to ProfileApp, then we should print out the
       // ProfileApp custom output.
@@ -263,21 +327,16 @@ namespace stm
    */
   void set_policy(const char* phasename)
   {
-      // prevent new txns from starting.  Note that we can't be in ProfileTM
-      // while doing this
-      while (true) {
-          int i = curr_policy.ALG_ID;
-          if (i == ProfileTM)
-              continue;
-          if (bcasptr(&TxThread::tmbegin, stms[i].begin, &begin_blocker))
-              break;
-          spin64();
+      uint64_t start = tick();
+
+#ifdef STM_STATIC_DISPATCH
+      // the program's barriers are compiled in, so we can't switch
+      if (strcmp(phasename, STM_STATIC_DISPATCH)) {
+          printf("set_policy(%s): ignored, since this libstm only runs %s\n",
+                 phasename, STM_STATIC_DISPATCH);
+          phasename = STM_STATIC_DISPATCH;
       }
-
-      // wait for everyone to be out of a transaction (scope == NULL)
-      for (unsigned i = 0; i < threadcount.val; ++i)
-          while (threads[i]->scope)
-              spin64();
+#endif
 
       // figure out the algorithm for the STM, and set the adapt policy
 
@@ -292,12 +351,44 @@ namespace stm
           new_algorithm = pols[tmp].startmode;
       }
 
+      // if the new algorithm shares metadata with the current one, we don't
+      // need to wait for in-flight transactions.  The policy fields are only
+      // hints to the triggers, so it's ok to set them after the switch.
+      if (install_algorithm_lazy(new_algorithm, Self)) {
+          curr_policy.POL_ID = new_policy;
+          curr_policy.waitThresh = pols[new_policy].waitThresh;
+          curr_policy.abortThresh = pols[new_policy].abortThresh;
+          return;
+      }
+
+      // prevent new txns from starting.  Note that we can't be in ProfileTM
+      // while doing this, but we can be sampling, and then we give up on the
+      // samples
+      while (true) {
+          int i = curr_policy.ALG_ID;
+          if (i == ProfileTM)
+              continue;
+          if (bcasptr(&TxThread::tmbegin, stms[i].begin, &begin_blocker))
+              break;
+          if (abandon_sampling())
+              break;
+          finish_lazy_switch();
+          spin64();
+      }
+
+      // wait for everyone to be out of a transaction (scope == NULL)
+      for (unsigned i = 0; i < threadcount.val; ++i)
+          while (threads[i]->scope)
+              spin64();
+
       curr_policy.POL_ID = new_policy;
       curr_policy.waitThresh = pols[new_policy].waitThresh;
       curr_policy.abortThresh = pols[new_policy].abortThresh;
 
       // install the new algorithm
       install_algorithm(new_algorithm, Self);
+      if (Self)
+          record_blocking_switch(tick() - start);
   }
 
   /**
@@ -355,6 +446,12 @@ namespace stm
               cfg = configstring;
           else
               printf("STM_CONFIG environment variable not found... using %s\n", cfg);
+#ifdef STM_STATIC_DISPATCH
+          if (strcmp(cfg, STM_STATIC_DISPATCH))
+              printf("STM_CONFIG=%s ignored, since this libstm only runs %s\n",
+                     cfg, STM_STATIC_DISPATCH);
+          cfg = STM_STATIC_DISPATCH;
+#endif
           init_lib_name = cfg;
 
           // now initialize the the adaptive policies
@@ -369,6 +466,38 @@ namespace stm
           for (unsigned i = 0; i < profile_txns; i++)
               profiles[i].clear();
 
+          // profiles are sampled concurrently unless STM_SAMPLE_RATE is 0,
+          // which selects the serializing ProfileTM
+          char* rate = getenv("STM_SAMPLE_RATE");
+          if (rate != NULL)
+              sample_rate = strtol(rate, 0, 10);
+          char* sthreads = getenv("STM_SAMPLE_THREADS");
+          if (sthreads != NULL)
+              sample_threads = strtol(sthreads, 0, 10);
+
+          // choose algorithms per atomic block, within the current family?
+          char* sites = getenv("STM_SITES");
+#ifdef STM_STATIC_DISPATCH
+          sites = NULL;
+#endif
+          if (sites != NULL && strtol(sites, 0, 10))
+              sites_init();
+
+          // report abort hotspots at shutdown?
+          conflicts_init();
+
+          // publish live statistics in shared memory?
+          shmstats_init();
+
+          // trace transaction events to a file?
+          trace_init();
+
+          // allocate from per-thread slabs instead of malloc?
+          SlabPool::init();
+
+          // free deferred blocks on a background thread?
+          WBMMPolicy::startReclaimer();
+
           // Initialize the global abort handler.
           if (conflict_abort_handler)
               TxThread::tmabort = conflict_abort_handler;
@@ -165,14 +165,13 @@ work (void* argPtr)
             membership[i] = index;
 
             /* Update new cluster centers : sum of objects located within */
+            /* Nobody reads them until the phase is over, so the sums are
+             * commutative updates, which don't conflict with each other
+             * under algorithms that can defer them (stm/deferred.hpp) */
             TM_BEGIN();
-            TM_SHARED_WRITE_I(*new_centers_len[index],
-                            TM_SHARED_READ_I(*new_centers_len[index]) + 1);
+            TM_SHARED_ADD_I(*new_centers_len[index], 1);
             for (j = 0; j < nfeatures; j++) {
-                TM_SHARED_WRITE_F(
-                    new_centers[index][j],
-                    (TM_SHARED_READ_F(new_centers[index][j]) + feature[i][j])
-                );
+                TM_SHARED_ADD_F(new_centers[index][j], feature[i][j]);
             }
             TM_END();
         }
@@ -189,7 +188,7 @@ work (void* argPtr)
     }
 
     TM_BEGIN();
-    TM_SHARED_WRITE_F(global_delta, TM_SHARED_READ_F(global_delta) + delta);
+    TM_SHARED_ADD_F(global_delta, delta);
     TM_END();
 
     TM_THREAD_EXIT();
@@ -297,7 +296,7 @@ normal_exec (int       nthreads,
         /* Replace old cluster centers with new_centers */
         for (i = 0; i < nclusters; i++) {
             for (j = 0; j < nfeatures; j++) {
-                if (new_centers_len[i] > 0) {
+                if (*new_centers_len[i] > 0) {
                     clusters[i][j] = new_centers[i][j] / *new_centers_len[i];
                 }
                 new_centers[i][j] = 0.0;   /* set back to 0 */
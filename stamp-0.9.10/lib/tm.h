@@ -591,6 +591,11 @@
 #  define TM_SHARED_WRITE_P(var, val)   ({var = val; var;})
 #  define TM_SHARED_WRITE_F(var, val)   ({var = val; var;})
 
+#  define TM_SHARED_ADD_I(var, val)     ((var) += (val))
+#  define TM_SHARED_ADD_L(var, val)     ((var) += (val))
+#  define TM_SHARED_ADD_F(var, val)     ((var) += (val))
+#  define TM_SHARED_PRINTF(...)         printf(__VA_ARGS__)
+
 #  define TM_LOCAL_WRITE_I(var, val)    ({var = val; var;})
 #  define TM_LOCAL_WRITE_L(var, val)    ({var = val; var;})
 #  define TM_LOCAL_WRITE_P(var, val)    ({var = val; var;})
@@ -611,6 +616,15 @@
 #  define TM_SHARED_WRITE_P(var, val)   STMWRITE(&var, val, (stm::TxThread*)STM_SELF)
 #  define TM_SHARED_WRITE_F(var, val)   STMWRITE(&var, val, (stm::TxThread*)STM_SELF)
 
+/* commutative updates, applied at commit without a read (stm/deferred.hpp) */
+#  define TM_SHARED_ADD_I(var, val)     stm::stm_add(&var, val, (stm::TxThread*)STM_SELF)
+#  define TM_SHARED_ADD_L(var, val)     stm::stm_add(&var, val, (stm::TxThread*)STM_SELF)
+#  define TM_SHARED_ADD_F(var, val)     stm::stm_add(&var, val, (stm::TxThread*)STM_SELF)
+
+/* output that is written once the transaction commits (txio.cpp) */
+#  define TM_SHARED_PRINTF(...) \
+    stm::stm_fprintf((stm::TxThread*)STM_SELF, stdout, __VA_ARGS__)
+
 #  define TM_LOCAL_WRITE_I(var, val)    STM_LOCAL_WRITE_I(var, val)
 #  define TM_LOCAL_WRITE_L(var, val)    STM_LOCAL_WRITE_L(var, val)
 #  define TM_LOCAL_WRITE_P(var, val)    STM_LOCAL_WRITE_P(var, val)
@@ -631,6 +645,11 @@
 #  define TM_SHARED_WRITE_P(var, val)   ({var = val; var;})
 #  define TM_SHARED_WRITE_F(var, val)   ({var = val; var;})
 
+#  define TM_SHARED_ADD_I(var, val)     ((var) += (val))
+#  define TM_SHARED_ADD_L(var, val)     ((var) += (val))
+#  define TM_SHARED_ADD_F(var, val)     ((var) += (val))
+#  define TM_SHARED_PRINTF(...)         printf(__VA_ARGS__)
+
 #  define TM_LOCAL_WRITE_I(var, val)    ({var = val; var;})
 #  define TM_LOCAL_WRITE_L(var, val)    ({var = val; var;})
 #  define TM_LOCAL_WRITE_P(var, val)    ({var = val; var;})
@@ -0,0 +1,171 @@
+/**
+ *  Copyright (C) 2011
+ *  University of Rochester Department of Computer Science
+ *    and
+ *  Lehigh University Department of Computer Science and Engineering
+ *
+ * License: Modified BSD
+ *          Please see the file LICENSE.RSTM for licensing information
+ */
+
+/**
+ *  stmstat: print the live statistics of a program that was run with
+ *  STM_SHM_STATS set (see libstm/shmstats.cpp).
+ *
+ *  With no options, it prints one snapshot of every thread's counters.  With
+ *  -i, it prints one line per interval with the rates over that interval,
+ *  which is the usual way to watch a long-running program.
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <stm/shmstats.hpp>
+
+using stm::shm_stats_t;
+using stm::shm_thread_stats_t;
+
+namespace
+{
+  void usage(const char* prog)
+  {
+      printf("Usage: %s [flags] <segment name>\n", prog);
+      printf("    -i: print rates every <ms> milliseconds\n");
+      printf("    -n: stop after <count> intervals (default forever)\n");
+      printf("    -h: print help (this message)\n\n");
+  }
+
+  /**
+   *  Copy a consistent snapshot of the segment: retry while the library is
+   *  in the middle of an update.  Returns false if the program is gone.
+   */
+  bool snapshot(const shm_stats_t* seg, shm_stats_t& out)
+  {
+      for (int tries = 0; tries < 1000; ++tries) {
+          uint64_t s = seg->seq;
+          __sync_synchronize();
+          if (s & 1) {
+              usleep(100);
+              continue;
+          }
+          memcpy(&out, (const void*)seg, sizeof(out));
+          __sync_synchronize();
+          if (seg->seq == s)
+              return true;
+      }
+      return false;
+  }
+
+  uint64_t commits(const shm_thread_stats_t& t)
+  {
+      return t.commits + t.ro_commits;
+  }
+
+  void print_row(const char* label, const shm_thread_stats_t& t, bool causes)
+  {
+      uint64_t c = commits(t);
+      printf("%-8s %12llu %12llu %12llu %12llu %12llu", label,
+             (unsigned long long)t.commits, (unsigned long long)t.ro_commits,
+             (unsigned long long)t.aborts, (unsigned long long)t.restarts,
+             (unsigned long long)(c ? t.txn_cycles / c : 0));
+      if (causes)
+          for (int k = 0; k < stm::CONFLICT_KINDS; ++k)
+              printf(" %s=%llu", stm::CONFLICT_NAMES[k],
+                     (unsigned long long)t.causes[k]);
+      printf("\n");
+  }
+
+  void print_snapshot(const shm_stats_t& s)
+  {
+      printf("pid %llu; algorithm %s; policy %s; %llu switches\n",
+             (unsigned long long)s.pid, s.algorithm, s.policy,
+             (unsigned long long)s.switches);
+      printf("%-8s %12s %12s %12s %12s %12s\n", "thread", "rw commits",
+             "ro commits", "aborts", "restarts", "cycles/txn");
+      for (uint32_t i = 0; i < s.threads && i < stm::MAX_THREADS; ++i) {
+          char label[16];
+          snprintf(label, sizeof(label), "%u", i + 1);
+          print_row(label, s.thread[i], s.causes_valid);
+      }
+      print_row("total", s.total, s.causes_valid);
+  }
+
+  /*** print the rates between two snapshots */
+  void print_rates(const shm_stats_t& a, const shm_stats_t& b, uint32_t ms)
+  {
+      uint64_t c = commits(b.total) - commits(a.total);
+      uint64_t ab = b.total.aborts - a.total.aborts;
+      uint64_t cyc = b.total.txn_cycles - a.total.txn_cycles;
+      printf("%-16s %10.0f commits/s %10.0f aborts/s %5.1f%% aborts "
+             "%10llu cycles/txn %llu switches\n", b.algorithm,
+             c * 1000.0 / ms, ab * 1000.0 / ms,
+             (c + ab) ? 100.0 * ab / (c + ab) : 0.0,
+             (unsigned long long)(c ? cyc / c : 0),
+             (unsigned long long)(b.switches - a.switches));
+      fflush(stdout);
+  }
+} // (anonymous namespace)
+
+int main(int argc, char** argv)
+{
+  uint32_t interval = 0;
+  long     count = -1;
+  int      opt;
+  while ((opt = getopt(argc, argv, "i:n:h")) != -1) {
+      switch (opt) {
+        case 'i': interval = strtol(optarg, NULL, 10); break;
+        case 'n': count = strtol(optarg, NULL, 10);    break;
+        case 'h': usage(argv[0]); return 0;
+        default:  usage(argv[0]); return 1;
+      }
+  }
+  if (optind != argc - 1) {
+      usage(argv[0]);
+      return 1;
+  }
+
+  char name[256];
+  snprintf(name, sizeof(name), "%s%s", (argv[optind][0] == '/') ? "" : "/",
+           argv[optind]);
+  int fd = shm_open(name, O_RDONLY, 0);
+  if (fd < 0) {
+      perror(name);
+      return 1;
+  }
+  void* p = mmap(NULL, sizeof(shm_stats_t), PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (p == MAP_FAILED) {
+      perror("mmap");
+      return 1;
+  }
+  const shm_stats_t* seg = (const shm_stats_t*)p;
+  if (memcmp(seg->magic, stm::SHM_STATS_MAGIC, sizeof(seg->magic)) ||
+      seg->version != stm::SHM_STATS_VERSION ||
+      seg->size != sizeof(shm_stats_t))
+  {
+      fprintf(stderr, "%s is not a libstm statistics segment that this "
+              "version of stmstat understands\n", name);
+      return 1;
+  }
+
+  static shm_stats_t prev, curr;
+  if (!snapshot(seg, curr)) {
+      fprintf(stderr, "%s is not being updated\n", name);
+      return 1;
+  }
+  if (!interval) {
+      print_snapshot(curr);
+      return 0;
+  }
+  while (count < 0 || count-- > 0) {
+      prev = curr;
+      usleep(interval * 1000);
+      if (!snapshot(seg, curr))
+          break;
+      print_rates(prev, curr, interval);
+  }
+  return 0;
+}
@@ -0,0 +1,274 @@
+/**
+ *  Copyright (C) 2011
+ *  University of Rochester Department of Computer Science
+ *    and
+ *  Lehigh University Department of Computer Science and Engineering
+ *
+ * License: Modified BSD
+ *          Please see the file LICENSE.RSTM for licensing information
+ */
+
+/**
+ *  stmtrace: read a trace file written by a program that was run with
+ *  STM_TRACE set (see include/stm/trace.hpp), and find abort storms.
+ *
+ *  By default, it cuts the run into intervals of equal length, prints the
+ *  commit rate, abort rate, dominant abort cause and algorithm of each
+ *  interval, and then summarizes every run of consecutive intervals in
+ *  which the abort ratio was at or above the storm threshold.  With -t, it
+ *  prints every event instead.
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include <algorithm>
+#include <unistd.h>
+#include <stm/trace.hpp>
+
+using stm::trace_event_t;
+using stm::trace_header_t;
+
+namespace
+{
+  void usage(const char* prog)
+  {
+      printf("Usage: %s [flags] <trace file>\n", prog);
+      printf("    -t: print the timeline of events\n");
+      printf("    -i: interval length in cycles (default: 1/50 of the run)\n");
+      printf("    -s: abort percentage that makes a storm (default 50)\n");
+      printf("    -h: print help (this message)\n\n");
+  }
+
+  bool by_time(const trace_event_t& a, const trace_event_t& b)
+  {
+      return a.time < b.time;
+  }
+
+  /*** the counts for an interval, or for a storm */
+  struct window_t
+  {
+      uint64_t commits;
+      uint64_t aborts;
+      uint64_t causes[stm::CONFLICT_KINDS];
+      uint64_t commit_reads, commit_writes;
+      uint64_t abort_reads, abort_writes;
+      uint32_t alg;     // algorithm at the end of the window
+      uint32_t switches;
+
+      void clear(uint32_t a)
+      {
+          memset(this, 0, sizeof(*this));
+          alg = a;
+      }
+
+      void add(const window_t& w)
+      {
+          commits += w.commits;
+          aborts += w.aborts;
+          for (int k = 0; k < stm::CONFLICT_KINDS; ++k)
+              causes[k] += w.causes[k];
+          commit_reads += w.commit_reads;
+          commit_writes += w.commit_writes;
+          abort_reads += w.abort_reads;
+          abort_writes += w.abort_writes;
+          alg = w.alg;
+          switches += w.switches;
+      }
+
+      double abort_pct() const
+      {
+          return (commits + aborts) ? 100.0 * aborts / (commits + aborts) : 0;
+      }
+
+      int dominant() const
+      {
+          int best = 0;
+          for (int k = 1; k < stm::CONFLICT_KINDS; ++k)
+              if (causes[k] > causes[best])
+                  best = k;
+          return best;
+      }
+  };
+
+  std::vector<char> names;
+  uint32_t          name_len;
+  uint32_t          alg_count;
+
+  const char* alg_name(uint32_t alg)
+  {
+      return (alg < alg_count) ? &names[alg * name_len] : "?";
+  }
+
+  void print_timeline(const std::vector<trace_event_t>& ev)
+  {
+      uint64_t t0 = ev.empty() ? 0 : ev[0].time;
+      for (size_t i = 0; i < ev.size(); ++i) {
+          const trace_event_t& e = ev[i];
+          printf("%14llu %4u %-8s", (unsigned long long)(e.time - t0),
+                 e.thread, (e.type < stm::TRACE_TYPES)
+                           ? stm::TRACE_NAMES[e.type] : "?");
+          if (e.type == stm::TRACE_ABORT && e.arg < stm::CONFLICT_KINDS)
+              printf(" %-10s", stm::CONFLICT_NAMES[e.arg]);
+          else if (e.type == stm::TRACE_SWITCH)
+              printf(" %-10s", alg_name(e.arg));
+          if (e.type == stm::TRACE_COMMIT || e.type == stm::TRACE_ABORT)
+              printf(" reads=%u writes=%u", e.reads, e.writes);
+          printf("\n");
+      }
+  }
+
+  void print_storm(int n, uint64_t from, uint64_t to, const window_t& w,
+                   uint32_t first_alg)
+  {
+      printf("Storm %d: cycles %llu-%llu, %.1f%% aborts (%llu aborts, "
+             "%llu commits), mostly %s\n", n, (unsigned long long)from,
+             (unsigned long long)to, w.abort_pct(),
+             (unsigned long long)w.aborts, (unsigned long long)w.commits,
+             stm::CONFLICT_NAMES[w.dominant()]);
+      printf("         algorithm %s", alg_name(first_alg));
+      if (w.switches)
+          printf(" -> %s (%u switches)", alg_name(w.alg), w.switches);
+      printf("; avg reads/writes %.1f/%.1f at abort, %.1f/%.1f at commit\n",
+             w.aborts ? (double)w.abort_reads / w.aborts : 0.0,
+             w.aborts ? (double)w.abort_writes / w.aborts : 0.0,
+             w.commits ? (double)w.commit_reads / w.commits : 0.0,
+             w.commits ? (double)w.commit_writes / w.commits : 0.0);
+  }
+
+  void print_intervals(const std::vector<trace_event_t>& ev, uint64_t len,
+                       double storm_pct, uint32_t alg)
+  {
+      if (ev.empty())
+          return;
+      uint64_t t0 = ev[0].time;
+      uint64_t span = ev.back().time - t0 + 1;
+      if (!len)
+          len = (span + 49) / 50;
+      if (!len)
+          len = 1;
+
+      printf("%14s %10s %10s %7s %14s %-10s %s\n", "cycle", "commits",
+             "aborts", "aborts", "commits/Mcyc", "cause", "algorithm");
+
+      window_t curr, storm;
+      curr.clear(alg);
+      storm.clear(alg);
+      uint32_t storm_alg = alg;
+      uint64_t storm_start = 0;
+      bool     in_storm = false;
+      int      storms = 0;
+      size_t   i = 0;
+      for (uint64_t start = 0; start < span; start += len) {
+          // count the events of [start, start + len)
+          uint32_t before = curr.alg;
+          curr.clear(before);
+          for (; i < ev.size() && ev[i].time - t0 < start + len; ++i) {
+              const trace_event_t& e = ev[i];
+              if (e.type == stm::TRACE_COMMIT) {
+                  ++curr.commits;
+                  curr.commit_reads += e.reads;
+                  curr.commit_writes += e.writes;
+              }
+              else if (e.type == stm::TRACE_ABORT) {
+                  ++curr.aborts;
+                  if (e.arg < stm::CONFLICT_KINDS)
+                      ++curr.causes[e.arg];
+                  curr.abort_reads += e.reads;
+                  curr.abort_writes += e.writes;
+              }
+              else if (e.type == stm::TRACE_SWITCH) {
+                  curr.alg = e.arg;
+                  ++curr.switches;
+              }
+          }
+          printf("%14llu %10llu %10llu %6.1f%% %14.1f %-10s %s\n",
+                 (unsigned long long)start, (unsigned long long)curr.commits,
+                 (unsigned long long)curr.aborts, curr.abort_pct(),
+                 curr.commits * 1e6 / len, curr.aborts
+                 ? stm::CONFLICT_NAMES[curr.dominant()] : "-",
+                 alg_name(curr.alg));
+
+          // merge consecutive stormy intervals
+          bool stormy = curr.aborts && curr.abort_pct() >= storm_pct;
+          if (stormy && !in_storm) {
+              storm.clear(before);
+              storm_alg = before;
+              storm_start = start;
+              in_storm = true;
+          }
+          if (stormy)
+              storm.add(curr);
+          else if (in_storm) {
+              print_storm(++storms, storm_start, start, storm, storm_alg);
+              in_storm = false;
+          }
+      }
+      if (in_storm)
+          print_storm(++storms, storm_start, span, storm, storm_alg);
+      if (!storms)
+          printf("No interval reached %.1f%% aborts\n", storm_pct);
+  }
+} // (anonymous namespace)
+
+int main(int argc, char** argv)
+{
+  bool     timeline = false;
+  uint64_t interval = 0;
+  double   storm_pct = 50;
+  int      opt;
+  while ((opt = getopt(argc, argv, "ti:s:h")) != -1) {
+      switch (opt) {
+        case 't': timeline = true;                       break;
+        case 'i': interval = strtoull(optarg, NULL, 10); break;
+        case 's': storm_pct = strtod(optarg, NULL);      break;
+        case 'h': usage(argv[0]); return 0;
+        default:  usage(argv[0]); return 1;
+      }
+  }
+  if (optind != argc - 1) {
+      usage(argv[0]);
+      return 1;
+  }
+
+  FILE* f = fopen(argv[optind], "rb");
+  if (!f) {
+      perror(argv[optind]);
+      return 1;
+  }
+  trace_header_t h;
+  if (fread(&h, sizeof(h), 1, f) != 1 ||
+      memcmp(h.magic, stm::TRACE_MAGIC, sizeof(h.magic)) ||
+      h.version != stm::TRACE_VERSION ||
+      h.event_size != sizeof(trace_event_t) || !h.name_len)
+  {
+      fprintf(stderr, "%s is not a libstm trace that this version of "
+              "stmtrace understands\n", argv[optind]);
+      return 1;
+  }
+  alg_count = h.alg_count;
+  name_len = h.name_len;
+  names.resize((size_t)alg_count * name_len);
+  if (alg_count && fread(&names[0], name_len, alg_count, f) != alg_count) {
+      fprintf(stderr, "%s: truncated algorithm table\n", argv[optind]);
+      return 1;
+  }
+  for (uint32_t a = 0; a < alg_count; ++a)
+      names[a * name_len + name_len - 1] = '\0';
+
+  // events from different threads arrive a buffer at a time
+  std::vector<trace_event_t> ev;
+  trace_event_t e;
+  while (fread(&e, sizeof(e), 1, f) == 1)
+      ev.push_back(e);
+  fclose(f);
+  std::stable_sort(ev.begin(), ev.end(), by_time);
+  printf("%lu events\n", (unsigned long)ev.size());
+
+  if (timeline)
+      print_timeline(ev);
+  else
+      print_intervals(ev, interval, storm_pct, h.initial_alg);
+  return 0;
+}